@@ -0,0 +1,122 @@
+#include "arena.h"
+#include <string.h>
+
+// Tamaño de cada bloque; un string más largo ocupa un bloque propio.
+#define TAM_BLOQUE (64 * 1024)
+
+/*******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS				   *
+ *******************************************************************/
+
+typedef struct bloque{
+	struct bloque* sig;
+	size_t usado;
+	size_t tam;
+	char datos[];
+}bloque_t;
+
+struct arena{
+	bloque_t* actual;	// Bloque donde se copia; los anteriores están llenos.
+	size_t memoria;		// Bytes de datos en todos los bloques.
+	size_t usados;		// Bytes de copias vigentes.
+	size_t liberados;	// Bytes de copias marcadas como sin uso.
+};
+
+static bloque_t *bloque_crear(size_t tam){
+	bloque_t *bloque = malloc(sizeof(bloque_t) + tam);
+	if (bloque == NULL){
+		return NULL;
+	}
+	bloque->sig = NULL;
+	bloque->usado = 0;
+	bloque->tam = tam;
+	return bloque;
+}
+
+/*******************************************************************
+ *                    PRIMITIVAS DE LA ARENA					   *
+ *******************************************************************/
+
+arena_t *arena_crear(void){
+	arena_t *arena = malloc(sizeof(arena_t));
+	if (arena == NULL){
+		return NULL;
+	}
+	arena->actual = NULL;
+	arena->memoria = 0;
+	arena->usados = 0;
+	arena->liberados = 0;
+	return arena;
+}
+
+char *arena_copiar(arena_t *arena, const void *datos, size_t largo){
+	size_t necesario = largo + 1;
+	bloque_t *bloque = arena->actual;
+	if (bloque == NULL || bloque->tam - bloque->usado < necesario){
+		bloque = bloque_crear(necesario > TAM_BLOQUE ? necesario : TAM_BLOQUE);
+		if (bloque == NULL){
+			return NULL;
+		}
+		if (necesario > TAM_BLOQUE && arena->actual != NULL){
+			// Un bloque propio no le quita lugar al bloque actual.
+			bloque->sig = arena->actual->sig;
+			arena->actual->sig = bloque;
+		} else{
+			bloque->sig = arena->actual;
+			arena->actual = bloque;
+		}
+		arena->memoria += bloque->tam;
+	}
+	char *copia = bloque->datos + bloque->usado;
+	memcpy(copia, datos, largo);
+	copia[largo] = '\0';
+	bloque->usado += necesario;
+	arena->usados += necesario;
+	return copia;
+}
+
+void arena_liberar(arena_t *arena, size_t largo){
+	arena->liberados += largo + 1;
+}
+
+bool arena_conviene_compactar(const arena_t *arena){
+	return arena->liberados > TAM_BLOQUE && arena->liberados > arena->usados - arena->liberados;
+}
+
+size_t arena_sin_uso(const arena_t *arena){
+	return arena->liberados;
+}
+
+void arena_fusionar(arena_t *destino, arena_t *origen){
+	bloque_t *ultimo = origen->actual;
+	if (ultimo != NULL){
+		while (ultimo->sig != NULL){
+			ultimo = ultimo->sig;
+		}
+		if (destino->actual == NULL){
+			destino->actual = origen->actual;
+		} else{
+			// Quedan detrás del bloque actual de destino, que sigue recibiendo copias.
+			ultimo->sig = destino->actual->sig;
+			destino->actual->sig = origen->actual;
+		}
+	}
+	destino->memoria += origen->memoria;
+	destino->usados += origen->usados;
+	destino->liberados += origen->liberados;
+	free(origen);
+}
+
+size_t arena_memoria(const arena_t *arena){
+	return arena->memoria;
+}
+
+void arena_destruir(arena_t *arena){
+	bloque_t *bloque = arena->actual;
+	while (bloque != NULL){
+		bloque_t *sig = bloque->sig;
+		free(bloque);
+		bloque = sig;
+	}
+	free(arena);
+}
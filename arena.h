@@ -0,0 +1,60 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+/*******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS				   *
+ *******************************************************************/
+
+// Arena de strings: copia cada string a continuación del anterior dentro de
+// bloques grandes, y libera todos los bloques juntos al destruirse.
+struct arena;
+typedef struct arena arena_t;
+
+
+/*******************************************************************
+ *                    PRIMITIVAS DE LA ARENA					   *
+ *******************************************************************/
+
+// Crea una arena vacía.
+// Pos: Devuelve una arena sin bloques, o NULL si no hay memoria.
+arena_t *arena_crear(void);
+
+// Copia los largo bytes de datos, más un '\0' final, dentro de la arena.
+// Devuelve la copia, o NULL si no hay memoria.
+// Pre: La arena fue creada.
+// Pos: La copia vive hasta que se destruya la arena.
+char *arena_copiar(arena_t *arena, const void *datos, size_t largo);
+
+// Marca como sin uso los largo + 1 bytes de una copia hecha con arena_copiar.
+// La memoria recién se recupera al compactar (ver arena_conviene_compactar).
+// Pre: La arena fue creada.
+void arena_liberar(arena_t *arena, size_t largo);
+
+// Devuelve verdadero si la mayor parte de la memoria de la arena quedó sin
+// uso. En ese caso conviene copiar lo que siga vivo a una arena nueva y
+// destruir esta.
+// Pre: La arena fue creada.
+bool arena_conviene_compactar(const arena_t *arena);
+
+// Devuelve la cantidad de bytes marcados como sin uso.
+// Pre: La arena fue creada.
+size_t arena_sin_uso(const arena_t *arena);
+
+// Pasa todos los bloques de origen a destino, y destruye origen.
+// Pre: Ambas arenas fueron creadas.
+// Post: Las copias de origen viven hasta que se destruya destino.
+void arena_fusionar(arena_t *destino, arena_t *origen);
+
+// Devuelve la cantidad de bytes pedidos en bloques por la arena.
+// Pre: La arena fue creada.
+size_t arena_memoria(const arena_t *arena);
+
+// Destruye la arena junto con todas sus copias.
+// Pre: La arena fue creada.
+// Post: Se liberaron todos los bloques.
+void arena_destruir(arena_t *arena);
+
+#endif  // ARENA_H
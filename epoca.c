@@ -0,0 +1,185 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "epoca.h"
+
+#define LINEA_CACHE 64
+// Cada cuántos retiros se intenta avanzar la época y liberar lo que se pueda.
+#define RETIROS_POR_RECOLECCION 64
+
+/*******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS				   *
+ *******************************************************************/
+
+// Registro de un hilo lector. Cada uno ocupa su propia línea de caché, así
+// la escritura de un lector no invalida la de otro.
+typedef struct lector{
+	_Alignas(LINEA_CACHE) _Atomic uint64_t epoca;	// Época en que entró, o 0 si no está leyendo.
+	atomic_bool en_uso;		// Lo está usando un hilo vivo.
+	struct lector* sig;
+}lector_t;
+
+typedef struct retirado{
+	void (*liberar)(void*);
+	void* ptr;
+	uint64_t epoca;			// Época global al momento de retirarlo.
+	struct retirado* sig;
+}retirado_t;
+
+// La época global arranca en 1 para que 0 signifique "fuera de una lectura".
+static _Atomic uint64_t epoca_global = 1;
+// Registros de todos los hilos que leyeron alguna vez. Sólo crece: los de
+// hilos terminados se reutilizan.
+static _Atomic(lector_t*) lectores = NULL;
+
+// Retirados del más nuevo al más viejo, protegidos por mutex_retirados.
+static pthread_mutex_t mutex_retirados = PTHREAD_MUTEX_INITIALIZER;
+static retirado_t* retirados = NULL;
+static size_t retiros_sin_recolectar = 0;
+
+static pthread_once_t clave_creada = PTHREAD_ONCE_INIT;
+static pthread_key_t clave_lector;
+
+static _Thread_local lector_t* propio = NULL;
+static _Thread_local unsigned anidamiento = 0;
+
+/*******************************************************************
+ *                        AUXILIARES							   *
+ *******************************************************************/
+
+// Destructor de clave_lector: libera el registro cuando el hilo termina.
+static void lector_soltar(void *dato){
+	lector_t *lector = dato;
+	atomic_store_explicit(&lector->epoca, 0, memory_order_release);
+	atomic_store_explicit(&lector->en_uso, false, memory_order_release);
+}
+
+static void clave_crear(void){
+	pthread_key_create(&clave_lector, lector_soltar);
+}
+
+static lector_t *lector_registrar(void){
+	pthread_once(&clave_creada, clave_crear);
+	lector_t *lector = atomic_load_explicit(&lectores, memory_order_acquire);
+	for (; lector != NULL; lector = lector->sig){
+		bool libre = false;
+		if (atomic_compare_exchange_strong(&lector->en_uso, &libre, true)){
+			break;
+		}
+	}
+	if (lector == NULL){
+		lector = aligned_alloc(LINEA_CACHE, sizeof(lector_t));
+		if (lector == NULL){
+			// Sin registro no hay forma segura de leer, ni de avisarle al que llamó.
+			fprintf(stderr, "epoca: sin memoria para registrar un hilo\n");
+			abort();
+		}
+		atomic_init(&lector->epoca, 0);
+		atomic_init(&lector->en_uso, true);
+		lector->sig = atomic_load_explicit(&lectores, memory_order_relaxed);
+		while (!atomic_compare_exchange_weak_explicit(&lectores, &lector->sig, lector,
+				memory_order_release, memory_order_relaxed));
+	}
+	pthread_setspecific(clave_lector, lector);
+	propio = lector;
+	return lector;
+}
+
+// Avanza la época global si todos los lectores activos ya la vieron.
+static void epoca_intentar_avanzar(void){
+	// Ordena las desconexiones hechas por el escritor antes de mirar a los lectores.
+	atomic_thread_fence(memory_order_seq_cst);
+	uint64_t actual = atomic_load(&epoca_global);
+	lector_t *lector = atomic_load_explicit(&lectores, memory_order_acquire);
+	for (; lector != NULL; lector = lector->sig){
+		uint64_t epoca = atomic_load_explicit(&lector->epoca, memory_order_acquire);
+		if (epoca != 0 && epoca != actual){
+			return;
+		}
+	}
+	atomic_compare_exchange_strong(&epoca_global, &actual, actual + 1);
+}
+
+// Separa de la lista los retirados que ya no puede ver ningún lector: los de
+// dos épocas atrás o más. Pre: mutex_retirados tomado.
+static retirado_t *retirados_separar_listos(void){
+	uint64_t global = atomic_load(&epoca_global);
+	retirado_t **anterior = &retirados;
+	while (*anterior != NULL && (*anterior)->epoca + 2 > global){
+		anterior = &(*anterior)->sig;
+	}
+	retirado_t *listos = *anterior;
+	*anterior = NULL;
+	return listos;
+}
+
+// Se llama sin el mutex tomado: liberar puede ser una función del usuario.
+static void retirados_liberar(retirado_t *listos){
+	while (listos != NULL){
+		retirado_t *sig = listos->sig;
+		listos->liberar(listos->ptr);
+		free(listos);
+		listos = sig;
+	}
+}
+
+/*******************************************************************
+ *                        PRIMITIVAS							   *
+ *******************************************************************/
+
+void epoca_entrar(void){
+	if (anidamiento++ > 0){
+		return;
+	}
+	lector_t *lector = propio != NULL ? propio : lector_registrar();
+	atomic_store_explicit(&lector->epoca, atomic_load_explicit(&epoca_global, memory_order_relaxed), memory_order_relaxed);
+	// El anuncio tiene que ser visible antes de leer cualquier puntero compartido.
+	atomic_thread_fence(memory_order_seq_cst);
+}
+
+void epoca_salir(void){
+	if (--anidamiento > 0){
+		return;
+	}
+	atomic_store_explicit(&propio->epoca, 0, memory_order_release);
+}
+
+void epoca_retirar(void (*liberar)(void *), void *ptr){
+	retirado_t *retirado = malloc(sizeof(retirado_t));
+	if (retirado == NULL){
+		epoca_sincronizar();
+		liberar(ptr);
+		return;
+	}
+	retirado->liberar = liberar;
+	retirado->ptr = ptr;
+	retirado_t *listos = NULL;
+	pthread_mutex_lock(&mutex_retirados);
+	retirado->epoca = atomic_load(&epoca_global);
+	retirado->sig = retirados;
+	retirados = retirado;
+	if (++retiros_sin_recolectar >= RETIROS_POR_RECOLECCION){
+		retiros_sin_recolectar = 0;
+		epoca_intentar_avanzar();
+		listos = retirados_separar_listos();
+	}
+	pthread_mutex_unlock(&mutex_retirados);
+	retirados_liberar(listos);
+}
+
+void epoca_sincronizar(void){
+	uint64_t objetivo = atomic_load(&epoca_global) + 2;
+	while (atomic_load(&epoca_global) < objetivo){
+		epoca_intentar_avanzar();
+		if (atomic_load(&epoca_global) < objetivo){
+			sched_yield();
+		}
+	}
+	pthread_mutex_lock(&mutex_retirados);
+	retirado_t *listos = retirados_separar_listos();
+	pthread_mutex_unlock(&mutex_retirados);
+	retirados_liberar(listos);
+}
@@ -0,0 +1,34 @@
+#ifndef EPOCA_H
+#define EPOCA_H
+
+#include <stdbool.h>
+
+/*******************************************************************
+ *              RECLAMACIÓN DE MEMORIA POR ÉPOCAS				   *
+ *******************************************************************/
+
+// Permite que un hilo libere memoria que otros hilos pueden estar leyendo
+// sin lock. Los lectores marcan sus lecturas con epoca_entrar/epoca_salir;
+// lo que se retira con epoca_retirar se libera recién cuando todos los
+// lectores que podían verlo salieron. El dominio es único para todo el
+// proceso.
+
+// Marca el comienzo de una lectura. Se puede anidar. No toma locks ni hace
+// operaciones atómicas de lectura-escritura (salvo la primera vez que un hilo
+// la llama, cuando se registra).
+void epoca_entrar(void);
+
+// Marca el fin de la lectura comenzada por el epoca_entrar correspondiente.
+// Pre: El hilo está dentro de una lectura.
+void epoca_salir(void);
+
+// Difiere liberar(ptr) hasta que ningún lector pueda estar usando ptr.
+// Pre: ptr ya no es alcanzable para los lectores que entren desde ahora.
+void epoca_retirar(void (*liberar)(void *), void *ptr);
+
+// Espera a que terminen las lecturas en curso y ejecuta todo lo retirado
+// hasta el momento.
+// Pre: El hilo que la llama no está dentro de una lectura.
+void epoca_sincronizar(void);
+
+#endif  // EPOCA_H
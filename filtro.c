@@ -0,0 +1,126 @@
+#include "filtro.h"
+#include <math.h>
+#include <string.h>
+
+// Un bloque son 8 palabras de 64 bits (una línea de caché) y cada hash
+// prende un bit en cada palabra, como el filtro de bloques partidos de
+// Parquet. Con 12 bits por elemento, cerca de 0,5% de falsos positivos.
+#define LINEA_CACHE 64
+#define PALABRAS_POR_BLOQUE 8
+#define BITS_POR_ELEMENTO 12
+#define BITS_POR_BLOQUE (PALABRAS_POR_BLOQUE * 64)
+
+/*******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS				   *
+ *******************************************************************/
+
+typedef struct bloque{
+	_Alignas(LINEA_CACHE) uint64_t palabras[PALABRAS_POR_BLOQUE];
+}bloque_t;
+
+struct filtro{
+	bloque_t* bloques;
+	size_t cant_bloques;
+	size_t capacidad;
+	size_t agregados;
+};
+
+// Multiplicadores impares: cada uno elige el bit de una palabra a partir de
+// los mismos 32 bits del hash.
+static const uint32_t sales[PALABRAS_POR_BLOQUE] = {
+	0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+	0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+};
+
+/*******************************************************************
+ *                        AUXILIARES							   *
+ *******************************************************************/
+
+// Los 32 bits altos eligen el bloque (sin módulo: se escalan al rango) y los
+// bajos, los bits dentro de él.
+static bloque_t *filtro_bloque(const filtro_t *filtro, uint64_t h){
+	return &filtro->bloques[(size_t) (((h >> 32) * (uint64_t) filtro->cant_bloques) >> 32)];
+}
+
+static uint64_t bit_de_palabra(uint64_t h, size_t i){
+	return (uint64_t) 1 << (((uint32_t) h * sales[i]) >> 26);
+}
+
+/*******************************************************************
+ *                    PRIMITIVAS DEL FILTRO						   *
+ *******************************************************************/
+
+filtro_t *filtro_crear(size_t capacidad){
+	filtro_t *filtro = malloc(sizeof(filtro_t));
+	if (filtro == NULL){
+		return NULL;
+	}
+	size_t cant_bloques = (capacidad * BITS_POR_ELEMENTO + BITS_POR_BLOQUE - 1) / BITS_POR_BLOQUE;
+	if (cant_bloques == 0){
+		cant_bloques = 1;
+	}
+	filtro->bloques = aligned_alloc(LINEA_CACHE, cant_bloques * sizeof(bloque_t));
+	if (filtro->bloques == NULL){
+		free(filtro);
+		return NULL;
+	}
+	memset(filtro->bloques, 0, cant_bloques * sizeof(bloque_t));
+	filtro->cant_bloques = cant_bloques;
+	filtro->capacidad = capacidad;
+	filtro->agregados = 0;
+	return filtro;
+}
+
+void filtro_agregar(filtro_t *filtro, uint64_t h){
+	bloque_t *bloque = filtro_bloque(filtro, h);
+	for (size_t i = 0; i < PALABRAS_POR_BLOQUE; i++){
+		bloque->palabras[i] |= bit_de_palabra(h, i);
+	}
+	filtro->agregados++;
+}
+
+bool filtro_puede_estar(const filtro_t *filtro, uint64_t h){
+	const bloque_t *bloque = filtro_bloque(filtro, h);
+	// Sin cortar al primer bit apagado: las 8 palabras están en la misma
+	// línea y así el bucle no tiene saltos difíciles de predecir.
+	uint64_t faltan = 0;
+	for (size_t i = 0; i < PALABRAS_POR_BLOQUE; i++){
+		uint64_t bit = bit_de_palabra(h, i);
+		faltan |= ~bloque->palabras[i] & bit;
+	}
+	return faltan == 0;
+}
+
+size_t filtro_capacidad(const filtro_t *filtro){
+	return filtro->capacidad;
+}
+
+size_t filtro_agregados(const filtro_t *filtro){
+	return filtro->agregados;
+}
+
+size_t filtro_memoria(const filtro_t *filtro){
+	return filtro->cant_bloques * sizeof(bloque_t);
+}
+
+double filtro_tasa_estimada(const filtro_t *filtro){
+	// Los elementos de un bloque siguen una distribución de Poisson de media
+	// lambda. Con j elementos, un bit dado de una palabra quedó prendido con
+	// probabilidad 1 - (63/64)^j, y un falso positivo necesita los 8.
+	double lambda = (double) filtro->agregados / (double) filtro->cant_bloques;
+	if (lambda <= 0){
+		return 0;
+	}
+	double desvio = 10 * sqrt(lambda) + 20;
+	double tasa = 0;
+	for (double j = fmax(0, floor(lambda - desvio)); j <= lambda + desvio; j++){
+		double probabilidad = exp(j * log(lambda) - lambda - lgamma(j + 1));
+		tasa += probabilidad * pow(1 - pow(63.0 / 64.0, j), PALABRAS_POR_BLOQUE);
+	}
+	return tasa;
+}
+
+void filtro_destruir(filtro_t *filtro){
+	free(filtro->bloques);
+	free(filtro);
+}
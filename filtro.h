@@ -0,0 +1,58 @@
+#ifndef FILTRO_H
+#define FILTRO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/*******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS				   *
+ *******************************************************************/
+
+// Filtro de Bloom por bloques: responde si un hash de 64 bits puede haber
+// sido agregado, sin falsos negativos y con algunos falsos positivos. Cada
+// hash ocupa bits de un único bloque de una línea de caché, así que una
+// consulta lee una sola línea. No permite quitar elementos: para eso se
+// crea otro con los que sigan.
+struct filtro;
+typedef struct filtro filtro_t;
+
+
+/*******************************************************************
+ *                    PRIMITIVAS DEL FILTRO						   *
+ *******************************************************************/
+
+// Crea un filtro vacío dimensionado para capacidad hashes.
+// Pos: Devuelve el filtro, o NULL si no hay memoria.
+filtro_t *filtro_crear(size_t capacidad);
+
+// Agrega el hash h.
+// Pre: El filtro fue creado.
+void filtro_agregar(filtro_t *filtro, uint64_t h);
+
+// Devuelve false si h seguro no fue agregado, true si puede haberlo sido.
+// Pre: El filtro fue creado.
+bool filtro_puede_estar(const filtro_t *filtro, uint64_t h);
+
+// Devuelve la cantidad de hashes para la que se dimensionó el filtro.
+// Pre: El filtro fue creado.
+size_t filtro_capacidad(const filtro_t *filtro);
+
+// Devuelve la cantidad de veces que se llamó a filtro_agregar.
+// Pre: El filtro fue creado.
+size_t filtro_agregados(const filtro_t *filtro);
+
+// Devuelve la cantidad de bytes que ocupan los bloques del filtro.
+// Pre: El filtro fue creado.
+size_t filtro_memoria(const filtro_t *filtro);
+
+// Devuelve la probabilidad de falso positivo esperada con los hashes
+// agregados hasta ahora, suponiendo que son distintos y están bien mezclados.
+// Pre: El filtro fue creado.
+double filtro_tasa_estimada(const filtro_t *filtro);
+
+// Destruye el filtro.
+// Pre: El filtro fue creado.
+void filtro_destruir(filtro_t *filtro);
+
+#endif  // FILTRO_H
@@ -1,95 +1,2653 @@
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
-#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "hash.h"
 #include "lista.h"
+#include "arena.h"
+#include "pool.h"
+#include "filtro.h"
+#include "hash_u64.h"
+#include "rueda.h"
+#include "wyhash.h"
+
+#ifdef __linux__
+#include <sys/random.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GRUPO_SIMD
+#endif
+
+#define TAM_INICIAL 32
+#define FACTOR_REDIMENSION 2
+// Máxima cantidad promedio de elementos por balde en el hash abierto.
+#define CARGA_MAX_ABIERTO 2
+// Máxima proporción (en décimos) de posiciones ocupadas o borradas en el hash cerrado.
+#define CARGA_MAX_CERRADO 7
+// Al borrar, la tabla se achica cuando los elementos no llegan a
+// 1/ACHICAR_DIVISOR de los que entran antes de agrandarla. La nueva es la
+// más chica en la que ocupan hasta la mitad de ese máximo: queda lejos de los
+// dos umbrales, así que guardar y borrar alrededor de uno de ellos no
+// redimensiona en cada operación.
+#define ACHICAR_DIVISOR 4
+// Un cache reserva lugar para capacidad + capacidad / CACHE_HOLGURA pares: lo
+// que sobra lo van ocupando los borrados que dejan los desalojos, y limpiarlos
+// cuesta una pasada por la tabla cada tantos desalojos.
+#define CACHE_HOLGURA 4
+// Marcas de las posiciones de un cache. Las desmarcadas por la mano llevan
+// CACHE_DESMARCADO y, en los bits de CACHE_EPOCA, la época en que se
+// desmarcaron: una época son capacidad desalojos.
+#define CACHE_SIN_USAR 0
+#define CACHE_USADO 1
+#define CACHE_DESMARCADO 0x80
+#define CACHE_EPOCA 0x7F
+// Baldes de la tabla vieja que se migran en cada operación durante una
+// redimensión incremental. Con 2 o más, la migración termina antes de que la
+// tabla nueva necesite agrandarse otra vez.
+#define MIGRAR_POR_OPERACION 4
+// Claves que hash_obtener_lote y hash_guardar_lote buscan a la vez.
+#define TAM_LOTE 16
+// hash_construir: claves mínimas por hilo para que valga la pena crearlo,
+// particiones por hilo (más particiones reparten mejor la carga) y baldes
+// mínimos por partición.
+#define CONSTRUIR_CLAVES_POR_HILO 4096
+#define CONSTRUIR_PARTICIONES_POR_HILO 16
+#define CONSTRUIR_BALDES_POR_PARTICION 64
+
+// Las claves de hasta CLAVE_CORTA_MAX bytes se guardan dentro del nodo, y
+// compararlas no hace leer otra línea de caché. Agrandarlo agranda todos los
+// nodos: con 23 un nodo ocupa 48 bytes, con 15, 40. Se puede cambiar al
+// compilar, con -DCLAVE_CORTA_MAX=15.
+#ifndef CLAVE_CORTA_MAX
+#define CLAVE_CORTA_MAX 23
+#endif
+
+// Imagen de hash_volcar: cabecera, bytes de control como los del hash
+// cerrado, ranuras y claves. La marca de orden permite rechazar imágenes de
+// una máquina con otro orden de bytes.
+#define IMAGEN_MAGIA "HASHIMG1"
+#define IMAGEN_ORDEN 0x0102030405060708ULL
+
+// El filtro de hash_filtro_activar se dimensiona para el doble de las claves
+// que hay al armarlo, y nunca para menos que esto.
+#define FILTRO_CAPACIDAD_MINIMA 1024
+
+// Bytes de control del hash cerrado: una posición ocupada guarda los 7 bits
+// bajos del hash de su clave (bit alto en 0); las libres tienen el bit alto en 1.
+#define CTRL_VACIO 0x80
+#define CTRL_BORRADO 0xFE
+#define CTRL_ES_LIBRE(c) ((c) & 0x80)
+#define H2(h) ((uint8_t) ((h) & 0x7F))
+#define H1(h) ((size_t) ((h) >> 7))
+// Ancho máximo de grupo. Los primeros GRUPO_MAX bytes de control se repiten al
+// final del arreglo para poder leer un grupo completo desde cualquier posición.
+#define GRUPO_MAX 32
 
 // ********** Definiciones **********
 
 typedef struct nodo{
-	char* clave;
+	// Copia de la clave con un '\0' agregado: dentro del nodo si es corta
+	// (ver clave_es_corta), y si no dentro de la arena del hash.
+	union{
+		char corta[CLAVE_CORTA_MAX + 1];
+		char* larga;
+	} clave;
+	size_t largo;
 	void* dato;
+	uint64_t hash;	// Hash de la clave, para redimensionar y comparar sin leer la clave.
 } nodo_t;
 
-struct hash{
-	lista_t** listas;
-	size_t tam:
+// Resultado de revisar un grupo de bytes de control: el bit i corresponde a
+// la posición (inicio + i) de la tabla.
+typedef struct grupo{
+	uint32_t coincidencias;	// Ocupadas cuyo H2 coincide.
+	uint32_t vacios;		// Vacías (terminan la búsqueda).
+	uint32_t libres;		// Vacías o borradas (sirven para insertar).
+} grupo_t;
+
+typedef grupo_t (*grupo_revisar_t)(const uint8_t* ctrl, uint8_t h2);
+
+// Arreglo de baldes (HASH_ABIERTO) o de posiciones (HASH_CERRADO).
+typedef struct tabla{
+	lista_t** listas;	// HASH_ABIERTO: listas de nodo_t*, creadas al usarse.
+	nodo_t* nodos;		// HASH_CERRADO: arreglo contiguo de nodos.
+	uint8_t* ctrl;		// HASH_CERRADO: tam + GRUPO_MAX bytes de control.
+	uint64_t* ocupados;	// HASH_ABIERTO: bit i en 1 si la lista del balde i tiene elementos.
+	uint8_t* referencias;	// Cache: 1 si la posición se usó desde que pasó la mano del CLOCK.
+	size_t tam;
 	size_t cant;
+	size_t borrados;
+} tabla_t;
+
+// Posición de la imagen: en lugar de punteros guarda desplazamientos, así
+// sirve en cualquier dirección en la que se mapee.
+typedef struct ranura{
+	uint64_t clave;		// Desde el comienzo del bloque de claves.
+	uint64_t largo;
+	uint64_t dato;		// Valor del puntero, tal cual se guardó.
+	uint64_t hash;
+} ranura_t;
+
+typedef struct imagen_cabecera{
+	char magia[8];
+	uint64_t orden;
+	uint64_t semilla;
+	uint64_t cantidad;
+	uint64_t tam;			// Posiciones; potencia de 2.
+	uint64_t ctrl;			// Desplazamientos desde el comienzo del archivo.
+	uint64_t ranuras;
+	uint64_t claves;
+	uint64_t largo_claves;
+} imagen_cabecera_t;
+
+// Imagen mapeada por hash_abrir_mmap.
+typedef struct mapa{
+	void* base;
+	size_t largo;
+	const ranura_t* ranuras;
+	const char* claves;
+} mapa_t;
+
+// Filtro de Bloom delante de las búsquedas (ver hash_filtro_activar).
+typedef struct filtrado{
+	filtro_t* filtro;			// NULL si no está activado.
+	size_t borrados;			// Claves borradas que siguen en el filtro.
+	size_t consultas;
+	size_t descartes;			// Consultas respondidas sólo con el filtro.
+	size_t falsos_positivos;	// Consultas que pasaron el filtro sin que la clave estuviera.
+} filtrado_t;
+
+// Límite y contadores de hash_crear_cache.
+typedef struct cache{
+	size_t capacidad;	// 0 si el hash no es un cache.
+	size_t mano;		// Próxima posición que revisa el CLOCK.
+	size_t aciertos;
+	size_t fallos;
+	size_t desalojos;
+} cache_t;
+
+// Vencimiento de un par guardado con hash_guardar_con_ttl. Está en la rueda,
+// para expirarlo, y en el índice de vencimientos, para encontrarlo desde la
+// clave sin agrandar los nodos de todos los hashes.
+typedef struct vigencia{
+	temporizador_t temporizador;	// Primero: el temporizador_t* de la rueda es el vigencia_t*.
+	uint64_t hash;
+	size_t largo;
+	struct vigencia* sig;	// Otra con el mismo hash de clave.
+	char clave[];
+} vigencia_t;
+
+typedef struct vencimientos{
+	rueda_t* rueda;
+	hash_u64_t* indice;	// Hash de la clave -> vigencia_t*, las del mismo hash enlazadas por sig.
+} vencimientos_t;
+
+struct hash{
+	hash_tipo_t tipo;
+	tabla_t tabla;
+	tabla_t vieja;		// Tabla en migración hacia tabla; vieja.tam == 0 si no hay.
+	size_t migrado;		// Próximo balde de vieja a migrar.
+	bool incremental;
+	size_t iteradores;	// Iteradores vivos: mientras haya, no se migra.
+	grupo_revisar_t grupo_revisar;
+	size_t ancho_grupo;
+	arena_t* claves;	// Copias de las claves, liberadas juntas al destruir.
+	hash_funcion_t funcion;
+	uint64_t semilla;
+	pool_t* pares;		// HASH_ABIERTO: nodo_t de los pares.
+	pool_t* eslabones;	// HASH_ABIERTO: nodos de las listas de los baldes.
+	mapa_t* mapa;		// Imagen de sólo lectura; NULL si el hash está en memoria.
+	size_t redimensiones;
+	size_t tam_minimo;	// Bajo este tamaño no se achica: TAM_INICIAL o el de hash_reservar.
+	filtrado_t filtrado;
+	cache_t cache;
+	vencimientos_t* vencimientos;	// NULL hasta el primer hash_guardar_con_ttl.
+	hash_reloj_t reloj;
 	hash_destruir_dato_t destruir_dato;
 };
 
-struct hash_iter{
-	lista_iter_t* lista_iter;
-	size_t indice_actual;
+typedef struct busqueda{
+	const void* clave;
+	size_t largo;
+	uint64_t hash;
+	nodo_t* nodo;
+} busqueda_t;
+
+typedef struct recopia{
+	arena_t* arena;
+	bool ok;
+} recopia_t;
+
+// Estado compartido por los hilos de hash_construir. Las particiones son
+// rangos contiguos de baldes, así que cada hilo escribe en baldes distintos.
+typedef struct construccion{
+	hash_t* hash;
+	const char* const* claves;
+	void* const* datos;
+	size_t n;
+	size_t* largos;
+	uint64_t* hashes;
+	size_t* orden;			// Índices de las claves, agrupados por partición.
+	size_t* inicios;		// Inicio de cada partición en orden (particiones + 1).
+	size_t* diferidas;		// HASH_CERRADO: claves de cada partición que se guardan al final.
+	size_t particiones;		// Potencia de 2.
+	unsigned desplazamiento;	// balde >> desplazamiento == partición.
+	size_t hilos;
+} construccion_t;
+
+typedef struct trabajador{
+	construccion_t* construccion;
+	size_t numero;
+	size_t* cuentas;	// Claves propias por partición; después, próxima posición en orden.
+	arena_t* claves;	// Copias de las claves; al final se fusionan con las del hash.
+	pool_t* pares;		// HASH_ABIERTO: ídem para los pares.
+	pool_t* eslabones;	// HASH_ABIERTO: ídem para los nodos de las listas.
+	size_t insertados;
+	bool ok;
+} trabajador_t;
+
+typedef struct visita{
+	hash_visitar_t visitar;
+	void* extra;
+	bool seguir;
+	_Atomic bool* cortar;	// hash_iterar_paralelo: avisa a los demás hilos que corten.
+} visita_t;
+
+// Rango de baldes de hash_iterar_paralelo. Los índices de 0 a vieja.tam
+// son de la tabla vieja, y los siguientes de la actual.
+typedef struct recorrido{
 	const hash_t* hash;
-};
+	size_t desde;
+	size_t hasta;
+	visita_t visita;
+} recorrido_t;
 
 // ********** Auxiliares **********
 
-// Función de hashing, la versión mas simple es generar la clave segun el string, pero también es estupidamente ineficiente.
-// La idea es usar una de las 2 primeras listadas en:: www.cse.yorku.ca/~oz/hash.html
-size_t f_hash(char* str){
- 	
+// Mezcla final de MurmurHash3: cada bit de la entrada afecta a todos los de
+// la salida.
+static uint64_t mezclar(uint64_t h){
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+// Semilla aleatoria para cada hash, para que no se puedan elegir de antemano
+// claves que colisionen. Si el sistema no da bytes aleatorios, se arma con la
+// hora, la dirección del hash y un contador.
+static uint64_t semilla_nueva(const hash_t* hash){
+	uint64_t semilla;
+#ifdef __linux__
+	if (getrandom(&semilla, sizeof(semilla), GRND_NONBLOCK) == (ssize_t) sizeof(semilla)){
+		return semilla;
+	}
+#endif
+	// Atómico: se pueden crear hashes desde varios hilos a la vez.
+	static _Atomic uint64_t contador = 0;
+	uint64_t numero = atomic_fetch_add(&contador, 1) + 1;
+	semilla = (uint64_t) time(NULL) ^ (uint64_t) (uintptr_t) hash ^ (numero << 32);
+	return mezclar(semilla);
+}
+
+static uint64_t funcion_hash(const hash_t* hash, const void* clave, size_t largo){
+	return hash->funcion(clave, largo, hash->semilla);
+}
+
+static bool clave_es_corta(size_t largo){
+	return largo <= CLAVE_CORTA_MAX;
+}
+
+static const char* nodo_clave(const nodo_t* nodo){
+	return clave_es_corta(nodo->largo) ? nodo->clave.corta : nodo->clave.larga;
+}
+
+// Completa el nodo copiando la clave dentro de él o a la arena. Devuelve
+// false si no hay memoria para la copia.
+static bool nodo_iniciar(nodo_t* nodo, arena_t* arena, const void* clave, size_t largo, void* dato, uint64_t h){
+	nodo->largo = largo;
+	nodo->dato = dato;
+	nodo->hash = h;
+	if (clave_es_corta(largo)){
+		memcpy(nodo->clave.corta, clave, largo);
+		nodo->clave.corta[largo] = '\0';
+		return true;
+	}
+	nodo->clave.larga = arena_copiar(arena, clave, largo);
+	return nodo->clave.larga != NULL;
+}
+
+// Marca como sin uso la copia de una clave que se quitó del hash.
+static void clave_liberar(hash_t* hash, size_t largo){
+	if (!clave_es_corta(largo)){
+		arena_liberar(hash->claves, largo);
+	}
+}
+
+// Compara primero el hash completo, que casi siempre descarta al nodo sin
+// leer su clave.
+static bool clave_igual(const nodo_t* nodo, const void* clave, size_t largo, uint64_t h){
+	return nodo->hash == h && nodo->largo == largo && memcmp(nodo_clave(nodo), clave, largo) == 0;
+}
+
+// Visitar de lista_iterar: corta al encontrar el nodo con la clave buscada.
+static bool comparar_clave(void* dato, void* extra){
+	nodo_t* nodo = dato;
+	busqueda_t* busqueda = extra;
+	if (clave_igual(nodo, busqueda->clave, busqueda->largo, busqueda->hash)){
+		busqueda->nodo = nodo;
+		return false;
+	}
+	return true;
+}
+
+// Condición de lista_buscar_y_borrar: el nodo tiene la clave buscada.
+static bool es_clave_buscada(void* dato, void* extra){
+	return !comparar_clave(dato, extra);
+}
+
+// ********** Grupos de control **********
+
+static grupo_t grupo_revisar_escalar(const uint8_t* ctrl, uint8_t h2){
+	grupo_t grupo = {0, 0, 0};
+	for (uint32_t i = 0; i < 16; i++){
+		grupo.coincidencias |= (uint32_t) (ctrl[i] == h2) << i;
+		grupo.vacios |= (uint32_t) (ctrl[i] == CTRL_VACIO) << i;
+		grupo.libres |= (uint32_t) (CTRL_ES_LIBRE(ctrl[i]) != 0) << i;
+	}
+	return grupo;
+}
+
+#ifdef GRUPO_SIMD
+__attribute__((target("sse2")))
+static grupo_t grupo_revisar_sse2(const uint8_t* ctrl, uint8_t h2){
+	__m128i bytes = _mm_loadu_si128((const __m128i*) ctrl);
+	grupo_t grupo;
+	grupo.coincidencias = (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8((char) h2)));
+	grupo.vacios = (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8((char) CTRL_VACIO)));
+	grupo.libres = (uint32_t) _mm_movemask_epi8(bytes);
+	return grupo;
+}
+
+__attribute__((target("avx2")))
+static grupo_t grupo_revisar_avx2(const uint8_t* ctrl, uint8_t h2){
+	__m256i bytes = _mm256_loadu_si256((const __m256i*) ctrl);
+	grupo_t grupo;
+	grupo.coincidencias = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8((char) h2)));
+	grupo.vacios = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8((char) CTRL_VACIO)));
+	grupo.libres = (uint32_t) _mm256_movemask_epi8(bytes);
+	return grupo;
+}
+#endif
+
+// Elige la revisión de grupos más ancha que soporte el procesador.
+static void grupo_elegir(hash_t* hash){
+	hash->grupo_revisar = grupo_revisar_escalar;
+	hash->ancho_grupo = 16;
+#ifdef GRUPO_SIMD
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")){
+		hash->grupo_revisar = grupo_revisar_avx2;
+		hash->ancho_grupo = 32;
+	} else if (__builtin_cpu_supports("sse2")){
+		hash->grupo_revisar = grupo_revisar_sse2;
+	}
+#endif
+}
+
+static void ctrl_asignar(tabla_t* tabla, size_t pos, uint8_t valor){
+	tabla->ctrl[pos] = valor;
+	if (pos < GRUPO_MAX){
+		tabla->ctrl[tabla->tam + pos] = valor;
+	}
+}
+
+static void ocupados_marcar(tabla_t* tabla, size_t balde){
+	tabla->ocupados[balde / 64] |= (uint64_t) 1 << (balde % 64);
+}
+
+static void ocupados_desmarcar(tabla_t* tabla, size_t balde){
+	tabla->ocupados[balde / 64] &= ~((uint64_t) 1 << (balde % 64));
+}
+
+// Devuelve el primer balde con elementos (o posición ocupada) desde i, o tam
+// si no hay. Saltea los vacíos de a 64 baldes con el mapa de ocupados, o de a
+// un grupo de posiciones con los bytes de control.
+static size_t tabla_proximo_ocupado(const hash_t* hash, const tabla_t* tabla, size_t i){
+	if (hash->tipo == HASH_CERRADO){
+		uint32_t mascara = hash->ancho_grupo == 32 ? UINT32_MAX : ((uint32_t) 1 << hash->ancho_grupo) - 1;
+		for (; i < tabla->tam; i += hash->ancho_grupo){
+			uint32_t ocupadas = ~hash->grupo_revisar(tabla->ctrl + i, 0).libres & mascara;
+			if (ocupadas){
+				// El grupo puede pasar del final y leer la copia del principio.
+				i += (size_t) __builtin_ctz(ocupadas);
+				return i < tabla->tam ? i : tabla->tam;
+			}
+		}
+		return tabla->tam;
+	}
+	while (i < tabla->tam){
+		uint64_t palabra = tabla->ocupados[i / 64] >> (i % 64);
+		if (palabra){
+			return i + (size_t) __builtin_ctzll(palabra);
+		}
+		i = (i / 64 + 1) * 64;
+	}
+	return tabla->tam;
+}
+
+// ********** Tablas **********
+
+static bool tabla_crear(tabla_t* tabla, hash_tipo_t tipo, size_t tam){
+	tabla->listas = NULL;
+	tabla->nodos = NULL;
+	tabla->ctrl = NULL;
+	tabla->ocupados = NULL;
+	tabla->referencias = NULL;
+	if (tipo == HASH_CERRADO){
+		tabla->nodos = malloc(tam * sizeof(nodo_t));
+		tabla->ctrl = malloc(tam + GRUPO_MAX);
+		if (tabla->nodos == NULL || tabla->ctrl == NULL){
+			free(tabla->nodos);
+			free(tabla->ctrl);
+			return false;
+		}
+		memset(tabla->ctrl, CTRL_VACIO, tam + GRUPO_MAX);
+	} else{
+		tabla->listas = calloc(tam, sizeof(lista_t*));
+		tabla->ocupados = calloc((tam + 63) / 64, sizeof(uint64_t));
+		if (tabla->listas == NULL || tabla->ocupados == NULL){
+			free(tabla->listas);
+			free(tabla->ocupados);
+			return false;
+		}
+	}
+	tabla->tam = tam;
+	tabla->cant = 0;
+	tabla->borrados = 0;
+	return true;
+}
+
+// Libera los arreglos de la tabla; las listas ya tienen que estar destruidas.
+static void tabla_liberar(tabla_t* tabla){
+	free(tabla->listas);
+	free(tabla->nodos);
+	free(tabla->ctrl);
+	free(tabla->ocupados);
+	free(tabla->referencias);
+	tabla->listas = NULL;
+	tabla->nodos = NULL;
+	tabla->ctrl = NULL;
+	tabla->ocupados = NULL;
+	tabla->referencias = NULL;
+	tabla->tam = 0;
+	tabla->cant = 0;
+	tabla->borrados = 0;
+}
+
+// Devuelve la primera posición libre (vacía o borrada) del recorrido de h.
+static size_t cerrado_posicion_libre(const hash_t* hash, const tabla_t* tabla, uint64_t h){
+	size_t mascara = tabla->tam - 1;
+	size_t pos = H1(h) & mascara;
+	while (true){
+		grupo_t grupo = hash->grupo_revisar(tabla->ctrl + pos, 0);
+		if (grupo.libres){
+			return (pos + (size_t) __builtin_ctz(grupo.libres)) & mascara;
+		}
+		pos = (pos + hash->ancho_grupo) & mascara;
+	}
+}
+
+// Devuelve la posición de la clave en el hash cerrado, o tam si no está. Sólo
+// se compara la clave de las posiciones cuyo byte de control coincide con H2
+// y cuyo hash completo es igual a h. Si libre no es NULL, deja ahí la primera
+// posición libre del recorrido (la misma que daría cerrado_posicion_libre),
+// o tam si la clave está antes de llegar a una.
+static size_t cerrado_buscar(const hash_t* hash, const tabla_t* tabla, const void* clave, size_t largo, uint64_t h, size_t* libre){
+	size_t mascara = tabla->tam - 1;
+	size_t pos = H1(h) & mascara;
+	if (libre != NULL){
+		*libre = tabla->tam;
+	}
+	while (true){
+		grupo_t grupo = hash->grupo_revisar(tabla->ctrl + pos, H2(h));
+		if (libre != NULL && *libre == tabla->tam && grupo.libres){
+			*libre = (pos + (size_t) __builtin_ctz(grupo.libres)) & mascara;
+		}
+		while (grupo.coincidencias){
+			size_t i = (pos + (size_t) __builtin_ctz(grupo.coincidencias)) & mascara;
+			if (clave_igual(&tabla->nodos[i], clave, largo, h)){
+				return i;
+			}
+			grupo.coincidencias &= grupo.coincidencias - 1;
+		}
+		if (grupo.vacios){
+			return tabla->tam;
+		}
+		pos = (pos + hash->ancho_grupo) & mascara;
+	}
+}
+
+// Busca la clave en una tabla, siendo h su hash.
+static nodo_t* tabla_buscar(const hash_t* hash, const tabla_t* tabla, const void* clave, size_t largo, uint64_t h){
+	if (hash->tipo == HASH_CERRADO){
+		size_t pos = cerrado_buscar(hash, tabla, clave, largo, h, NULL);
+		return pos < tabla->tam ? &tabla->nodos[pos] : NULL;
+	}
+	lista_t* lista = tabla->listas[h & (tabla->tam - 1)];
+	if (lista == NULL){
+		return NULL;
+	}
+	busqueda_t busqueda = {clave, largo, h, NULL};
+	lista_iterar(lista, comparar_clave, &busqueda);
+	return busqueda.nodo;
+}
+
+// Copia el nodo en la posición libre pos del hash cerrado.
+static nodo_t* cerrado_ocupar(tabla_t* tabla, size_t pos, const nodo_t* nodo){
+	if (tabla->ctrl[pos] == CTRL_BORRADO){
+		tabla->borrados--;
+	}
+	ctrl_asignar(tabla, pos, H2(nodo->hash));
+	tabla->nodos[pos] = *nodo;
+	if (tabla->referencias != NULL){
+		tabla->referencias[pos] = CACHE_SIN_USAR;
+	}
+	tabla->cant++;
+	return &tabla->nodos[pos];
+}
+
+// Inserta un nodo cuya clave no está en la tabla, y devuelve el nodo que
+// quedó en ella (NULL si faltó memoria). En el hash abierto la tabla se queda
+// con el nodo (que debe salir del pool de pares); en el cerrado se copia su
+// contenido.
+static nodo_t* tabla_insertar(const hash_t* hash, tabla_t* tabla, nodo_t* nodo){
+	if (hash->tipo == HASH_CERRADO){
+		return cerrado_ocupar(tabla, cerrado_posicion_libre(hash, tabla, nodo->hash), nodo);
+	}
+	size_t balde = (size_t) nodo->hash & (tabla->tam - 1);
+	if (tabla->listas[balde] == NULL){
+		tabla->listas[balde] = lista_crear_con_pool(hash->eslabones);
+		if (tabla->listas[balde] == NULL){
+			return NULL;
+		}
+	}
+	if (!lista_insertar_primero(tabla->listas[balde], nodo)){
+		return NULL;
+	}
+	ocupados_marcar(tabla, balde);
+	tabla->cant++;
+	return nodo;
+}
+
+// Saca la clave de la tabla y copia el par en quitado. Devuelve false si no estaba.
+static bool tabla_quitar(const hash_t* hash, tabla_t* tabla, const void* clave, size_t largo, uint64_t h, nodo_t* quitado){
+	if (hash->tipo == HASH_CERRADO){
+		size_t pos = cerrado_buscar(hash, tabla, clave, largo, h, NULL);
+		if (pos == tabla->tam){
+			return false;
+		}
+		*quitado = tabla->nodos[pos];
+		ctrl_asignar(tabla, pos, CTRL_BORRADO);
+		tabla->borrados++;
+		tabla->cant--;
+		return true;
+	}
+
+	size_t balde = (size_t) h & (tabla->tam - 1);
+	lista_t* lista = tabla->listas[balde];
+	if (lista == NULL){
+		return false;
+	}
+	busqueda_t busqueda = {clave, largo, h, NULL};
+	nodo_t* nodo = lista_buscar_y_borrar(lista, es_clave_buscada, &busqueda);
+	if (nodo == NULL){
+		return false;
+	}
+	if (lista_esta_vacia(lista)){
+		ocupados_desmarcar(tabla, balde);
+	}
+	*quitado = *nodo;
+	pool_devolver(hash->pares, nodo);
+	tabla->cant--;
+	return true;
+}
+
+// Llama a destruir_dato para cada par de la tabla y la libera. Los nodos se
+// liberan junto con los pools del hash.
+static void tabla_destruir(hash_t* hash, tabla_t* tabla){
+	for (size_t i = 0; i < tabla->tam; i++){
+		if (hash->tipo == HASH_CERRADO){
+			if (CTRL_ES_LIBRE(tabla->ctrl[i])){
+				continue;
+			}
+			if (hash->destruir_dato){
+				hash->destruir_dato(tabla->nodos[i].dato);
+			}
+			continue;
+		}
+		lista_t* lista = tabla->listas[i];
+		if (lista == NULL){
+			continue;
+		}
+		while (!lista_esta_vacia(lista)){
+			nodo_t* nodo = lista_borrar_primero(lista);
+			if (hash->destruir_dato){
+				hash->destruir_dato(nodo->dato);
+			}
+		}
+		lista_destruir(lista, NULL);
+	}
+	tabla_liberar(tabla);
+}
+
+// Visitar de lista_iterar: copia la clave del nodo a la arena de la recopia,
+// si es de las que están en la arena.
+static bool recopiar_clave(void* dato, void* extra){
+	nodo_t* nodo = dato;
+	recopia_t* recopia = extra;
+	if (clave_es_corta(nodo->largo)){
+		return true;
+	}
+	char* copia = arena_copiar(recopia->arena, nodo->clave.larga, nodo->largo);
+	if (copia == NULL){
+		recopia->ok = false;
+		return false;
+	}
+	nodo->clave.larga = copia;
+	return true;
+}
+
+// Copia las claves de la tabla a la arena; devuelve false si faltó memoria
+// (y en ese caso algunas claves quedaron sin copiar).
+static bool tabla_recopiar_claves(const hash_t* hash, tabla_t* tabla, arena_t* arena){
+	recopia_t recopia = {arena, true};
+	for (size_t i = 0; i < tabla->tam && recopia.ok; i++){
+		if (hash->tipo == HASH_CERRADO){
+			if (!CTRL_ES_LIBRE(tabla->ctrl[i])){
+				recopiar_clave(&tabla->nodos[i], &recopia);
+			}
+		} else if (tabla->listas[i] != NULL){
+			lista_iterar(tabla->listas[i], recopiar_clave, &recopia);
+		}
+	}
+	return recopia.ok;
+}
+
+// Pasa las claves vigentes a una arena nueva, para recuperar la memoria de
+// las borradas. Si falta memoria a mitad de camino, conserva las dos arenas.
+static void hash_compactar_claves(hash_t* hash){
+	arena_t* nueva = arena_crear();
+	if (nueva == NULL){
+		return;
+	}
+	if (tabla_recopiar_claves(hash, &hash->vieja, nueva) && tabla_recopiar_claves(hash, &hash->tabla, nueva)){
+		arena_destruir(hash->claves);
+	} else{
+		arena_fusionar(nueva, hash->claves);
+	}
+	hash->claves = nueva;
+}
+
+static bool hash_migrando(const hash_t* hash){
+	return hash->vieja.tam > 0;
+}
+
+// ********** Filtro **********
+
+static void tabla_filtrar(const hash_t* hash, const tabla_t* tabla, filtro_t* filtro){
+	if (tabla->tam == 0){
+		return;
+	}
+	for (size_t i = tabla_proximo_ocupado(hash, tabla, 0); i < tabla->tam; i = tabla_proximo_ocupado(hash, tabla, i + 1)){
+		if (hash->tipo == HASH_CERRADO){
+			filtro_agregar(filtro, tabla->nodos[i].hash);
+			continue;
+		}
+		for (lista_pos_t pos = lista_pos_primera(tabla->listas[i]); pos != NULL; pos = lista_pos_siguiente(pos)){
+			const nodo_t* nodo = lista_pos_ver(pos);
+			filtro_agregar(filtro, nodo->hash);
+		}
+	}
+}
+
+// Reemplaza el filtro por uno nuevo con las claves que hay ahora. Si falta
+// memoria deja el anterior, que no da falsos negativos aunque le sobren
+// claves, y devuelve false.
+static bool filtro_reconstruir(hash_t* hash){
+	size_t capacidad = hash_cantidad(hash) * 2;
+	filtro_t* filtro = filtro_crear(capacidad > FILTRO_CAPACIDAD_MINIMA ? capacidad : FILTRO_CAPACIDAD_MINIMA);
+	if (filtro == NULL){
+		return false;
+	}
+	tabla_filtrar(hash, &hash->tabla, filtro);
+	tabla_filtrar(hash, &hash->vieja, filtro);
+	if (hash->filtrado.filtro != NULL){
+		filtro_destruir(hash->filtrado.filtro);
+	}
+	hash->filtrado.filtro = filtro;
+	hash->filtrado.borrados = 0;
+	return true;
+}
+
+// Agrega al filtro la clave de hash h, recién guardada en la tabla. Si el
+// filtro ya tiene todas las claves para las que se dimensionó, lo rearma.
+static void filtro_guardado(hash_t* hash, uint64_t h){
+	filtro_t* filtro = hash->filtrado.filtro;
+	if (filtro == NULL){
+		return;
+	}
+	if (filtro_agregados(filtro) < filtro_capacidad(filtro) || !filtro_reconstruir(hash)){
+		filtro_agregar(filtro, h);
+	}
+}
+
+// Cuenta una clave borrada. Cuando las borradas superan a las vigentes, el
+// filtro daría más falsos positivos que uno nuevo y se rearma; así el costo
+// de rearmarlo queda repartido entre los borrados.
+static void filtro_borrado(hash_t* hash){
+	if (hash->filtrado.filtro != NULL && ++hash->filtrado.borrados > hash_cantidad(hash)){
+		filtro_reconstruir(hash);
+	}
+}
+
+// Devuelve true si el filtro asegura que la clave de hash h no está.
+static bool filtro_descarta(const hash_t* hash, uint64_t h){
+	// Los contadores se actualizan desde búsquedas sobre un const hash_t*:
+	// el hash se creó con malloc, como al migrar desde hash_obtener.
+	filtrado_t* filtrado = (filtrado_t*) &hash->filtrado;
+	if (filtrado->filtro == NULL){
+		return false;
+	}
+	filtrado->consultas++;
+	if (filtro_puede_estar(filtrado->filtro, h)){
+		return false;
+	}
+	filtrado->descartes++;
+	return true;
+}
+
+// Cuenta una búsqueda que pasó el filtro y no encontró la clave.
+static void filtro_fallo(const hash_t* hash){
+	filtrado_t* filtrado = (filtrado_t*) &hash->filtrado;
+	if (filtrado->filtro != NULL){
+		filtrado->falsos_positivos++;
+	}
+}
+
+// ********** Vencimientos **********
+
+static bool vencimientos_crear(hash_t* hash, uint64_t ahora){
+	vencimientos_t* vencimientos = malloc(sizeof(vencimientos_t));
+	if (vencimientos == NULL){
+		return false;
+	}
+	vencimientos->rueda = rueda_crear(ahora);
+	vencimientos->indice = hash_u64_crear(NULL);
+	if (vencimientos->rueda == NULL || vencimientos->indice == NULL){
+		if (vencimientos->rueda != NULL){
+			rueda_destruir(vencimientos->rueda);
+		}
+		if (vencimientos->indice != NULL){
+			hash_u64_destruir(vencimientos->indice);
+		}
+		free(vencimientos);
+		return false;
+	}
+	hash->vencimientos = vencimientos;
+	return true;
+}
+
+static void vencimientos_destruir(vencimientos_t* vencimientos){
+	// Todas las vigencias están en la rueda, y sacarlas no pide memoria.
+	temporizador_t* temporizador;
+	while ((temporizador = rueda_sacar_vencido(vencimientos->rueda, UINT64_MAX)) != NULL){
+		free((vigencia_t*) temporizador);
+	}
+	hash_u64_destruir(vencimientos->indice);
+	rueda_destruir(vencimientos->rueda);
+	free(vencimientos);
+}
+
+static vigencia_t* vigencia_buscar(const hash_t* hash, const void* clave, size_t largo, uint64_t h){
+	vigencia_t* vigencia = hash_u64_obtener(hash->vencimientos->indice, h);
+	while (vigencia != NULL && (vigencia->largo != largo || memcmp(vigencia->clave, clave, largo) != 0)){
+		vigencia = vigencia->sig;
+	}
+	return vigencia;
+}
+
+// Saca la vigencia del índice, sin liberarla.
+static void vigencia_desindexar(hash_t* hash, vigencia_t* vigencia){
+	hash_u64_t* indice = hash->vencimientos->indice;
+	vigencia_t* primera = hash_u64_obtener(indice, vigencia->hash);
+	if (primera != vigencia){
+		while (primera->sig != vigencia){
+			primera = primera->sig;
+		}
+		primera->sig = vigencia->sig;
+	} else if (vigencia->sig != NULL){
+		// Reemplazar el dato de una clave que ya está no pide memoria.
+		hash_u64_guardar(indice, vigencia->hash, vigencia->sig);
+	} else{
+		hash_u64_borrar(indice, vigencia->hash);
+	}
+}
+
+// Si la clave tiene vencimiento, se lo quita.
+static void vencimiento_descartar(hash_t* hash, const void* clave, size_t largo, uint64_t h){
+	if (hash->vencimientos == NULL){
+		return;
+	}
+	vigencia_t* vigencia = vigencia_buscar(hash, clave, largo, h);
+	if (vigencia != NULL){
+		rueda_quitar(hash->vencimientos->rueda, &vigencia->temporizador);
+		vigencia_desindexar(hash, vigencia);
+		free(vigencia);
+	}
+}
+
+// Devuelve true si la clave tiene un vencimiento que ya pasó según el reloj
+// del hash. Sólo lee el reloj para las claves con vencimiento.
+static bool vencida(const hash_t* hash, const void* clave, size_t largo, uint64_t h){
+	if (hash->vencimientos == NULL){
+		return false;
+	}
+	vigencia_t* vigencia = vigencia_buscar(hash, clave, largo, h);
+	return vigencia != NULL && rueda_vencimiento(&vigencia->temporizador) <= hash->reloj();
+}
+
+// ********** Borrado **********
+
+// Lo que sigue a sacar de la tabla un par con una clave de largo bytes:
+// liberar la clave, avisarle al filtro y compactar las claves si conviene.
+static void par_quitado(hash_t* hash, size_t largo){
+	clave_liberar(hash, largo);
+	filtro_borrado(hash);
+	// Compactar recorre todas las posiciones: se espera a que lo recuperable
+	// lo justifique, para que el costo quede amortizado entre los borrados.
+	size_t posiciones = hash->tabla.tam + hash->vieja.tam;
+	if (arena_conviene_compactar(hash->claves) && arena_sin_uso(hash->claves) >= posiciones * sizeof(void*)){
+		hash_compactar_claves(hash);
+	}
+}
+
+// Saca el par de la clave, con su vencimiento, y deja su dato en dato.
+// Devuelve false si no estaba.
+static bool par_borrar(hash_t* hash, const void* clave, size_t largo, uint64_t h, void** dato){
+	nodo_t quitado;
+	if (!tabla_quitar(hash, &hash->tabla, clave, largo, h, &quitado)
+			&& !(hash_migrando(hash) && tabla_quitar(hash, &hash->vieja, clave, largo, h, &quitado))){
+		return false;
+	}
+	vencimiento_descartar(hash, clave, largo, h);
+	par_quitado(hash, largo);
+	*dato = quitado.dato;
+	return true;
+}
+
+// ********** Cache **********
+
+// Marca como usado el nodo de un cache, si no lo estaba: así una búsqueda
+// sólo escribe la primera vez que encuentra la clave en cada vuelta de la mano.
+static void cache_usado(const hash_t* hash, const nodo_t* nodo){
+	// Como al migrar desde hash_obtener, el hash se creó con malloc.
+	tabla_t* tabla = (tabla_t*) &hash->tabla;
+	if (tabla->referencias == NULL){
+		return;
+	}
+	size_t pos = (size_t) (nodo - tabla->nodos);
+	if (tabla->referencias[pos] != CACHE_USADO){
+		tabla->referencias[pos] = CACHE_USADO;
+	}
+}
+
+// Cuenta una búsqueda de hash_obtener en un cache, y si encontró la clave
+// marca su nodo.
+static void cache_buscado(const hash_t* hash, const nodo_t* nodo){
+	cache_t* cache = (cache_t*) &hash->cache;
+	if (cache->capacidad == 0){
+		return;
+	}
+	if (nodo == NULL){
+		cache->fallos++;
+		return;
+	}
+	cache->aciertos++;
+	cache_usado(hash, nodo);
+}
+
+// Saca un par con el algoritmo CLOCK: la mano recorre las posiciones en
+// círculo, desmarca las usadas desde que pasó por última vez y desaloja la
+// primera que encuentra sin marcar. Para que un par desmarcado tenga tiempo
+// de volver a usarse se exige que hayan pasado dos épocas desde que se
+// desmarcó, en vez de una vuelta de la mano: limpiar los borrados reubica los
+// pares, y uno recién desmarcado puede quedar justo adelante de ella. Si en
+// una vuelta entera no encuentra ninguno, desaloja el primero desmarcado.
+// Pre: el cache no está vacío ni migrando.
+static void cache_desalojar(hash_t* hash){
+	tabla_t* tabla = &hash->tabla;
+	size_t mascara = tabla->tam - 1;
+	size_t pos = hash->cache.mano & mascara;
+	uint8_t epoca = (uint8_t) ((hash->cache.desalojos / hash->cache.capacidad) & CACHE_EPOCA);
+	for (size_t pasos = 0;; pasos++, pos = (pos + 1) & mascara){
+		if (CTRL_ES_LIBRE(tabla->ctrl[pos])){
+			continue;
+		}
+		uint8_t marca = tabla->referencias[pos];
+		if (marca == CACHE_USADO){
+			tabla->referencias[pos] = CACHE_DESMARCADO | epoca;
+		} else if (marca == CACHE_SIN_USAR || pasos > mascara || ((epoca - marca) & CACHE_EPOCA) >= 2){
+			break;
+		}
+	}
+	nodo_t desalojado = tabla->nodos[pos];
+	ctrl_asignar(tabla, pos, CTRL_BORRADO);
+	tabla->borrados++;
+	tabla->cant--;
+	hash->cache.mano = pos + 1;
+	hash->cache.desalojos++;
+	vencimiento_descartar(hash, nodo_clave(&desalojado), desalojado.largo, desalojado.hash);
+	par_quitado(hash, desalojado.largo);
+	if (hash->destruir_dato){
+		hash->destruir_dato(desalojado.dato);
+	}
+}
+
+// ********** Redimensión **********
+
+// Mueve a la tabla nueva el contenido del balde i de la vieja.
+static bool migrar_balde(hash_t* hash, size_t i){
+	tabla_t* vieja = &hash->vieja;
+	if (hash->tipo == HASH_CERRADO){
+		if (CTRL_ES_LIBRE(vieja->ctrl[i])){
+			return true;
+		}
+		nodo_t* nodo = tabla_insertar(hash, &hash->tabla, &vieja->nodos[i]);
+		if (vieja->referencias != NULL){
+			hash->tabla.referencias[nodo - hash->tabla.nodos] = vieja->referencias[i];
+		}
+		// Queda como borrada para no cortar los recorridos que pasan por acá.
+		ctrl_asignar(vieja, i, CTRL_BORRADO);
+		vieja->borrados++;
+		vieja->cant--;
+		return true;
+	}
+	lista_t* lista = vieja->listas[i];
+	if (lista == NULL){
+		return true;
+	}
+	while (!lista_esta_vacia(lista)){
+		nodo_t* nodo = lista_borrar_primero(lista);
+		if (!tabla_insertar(hash, &hash->tabla, nodo)){
+			// Sólo falla al crear la lista del balde nuevo: el nodo de lista
+			// recién devuelto al pool garantiza poder reinsertarlo.
+			lista_insertar_primero(lista, nodo);
+			return false;
+		}
+		vieja->cant--;
+	}
+	// Se destruye ahora y no al terminar, para no liberar todas las listas
+	// juntas en una misma operación.
+	lista_destruir(lista, NULL);
+	vieja->listas[i] = NULL;
+	ocupados_desmarcar(vieja, i);
+	return true;
+}
+
+// Migra hasta 'baldes' baldes de la tabla vieja; al terminar la libera.
+static bool hash_migrar(hash_t* hash, size_t baldes){
+	while (baldes > 0 && hash->migrado < hash->vieja.tam){
+		if (!migrar_balde(hash, hash->migrado)){
+			return false;
+		}
+		hash->migrado++;
+		baldes--;
+	}
+	if (hash->vieja.tam > 0 && hash->migrado == hash->vieja.tam){
+		tabla_liberar(&hash->vieja);
+		hash->migrado = 0;
+	}
+	return true;
+}
+
+// Un paso de la redimensión incremental, si hay una en curso y ningún
+// iterador la impide.
+static void hash_migrar_paso(hash_t* hash){
+	if (hash_migrando(hash) && hash->iteradores == 0){
+		hash_migrar(hash, MIGRAR_POR_OPERACION);
+	}
+}
+
+// Crea una tabla para el hash; la de un cache lleva bits de referencia.
+static bool hash_tabla_crear(const hash_t* hash, tabla_t* tabla, size_t tam){
+	if (!tabla_crear(tabla, hash->tipo, tam)){
+		return false;
+	}
+	if (hash->cache.capacidad > 0){
+		tabla->referencias = calloc(tam, sizeof(uint8_t));
+		if (tabla->referencias == NULL){
+			tabla_liberar(tabla);
+			return false;
+		}
+	}
+	return true;
+}
+
+// Reemplaza la tabla por una de tam_nuevo. En modo incremental sólo deja la
+// tabla actual como vieja; si no, migra todo de una vez.
+static bool hash_redimensionar(hash_t* hash, size_t tam_nuevo){
+	if (hash_migrando(hash) && !hash_migrar(hash, hash->vieja.tam)){
+		return false;
+	}
+	tabla_t nueva;
+	if (!hash_tabla_crear(hash, &nueva, tam_nuevo)){
+		return false;
+	}
+	hash->vieja = hash->tabla;
+	hash->tabla = nueva;
+	hash->migrado = 0;
+	hash->redimensiones++;
+	if (hash->incremental && hash->iteradores == 0){
+		return hash_migrar(hash, MIGRAR_POR_OPERACION);
+	}
+	return hash_migrar(hash, hash->vieja.tam);
+}
+
+static void hash_pools_destruir(hash_t* hash){
+	if (hash->pares != NULL){
+		pool_destruir(hash->pares);
+	}
+	if (hash->eslabones != NULL){
+		pool_destruir(hash->eslabones);
+	}
+}
+
+// Elementos que entran en una tabla de tam posiciones antes de agrandarla.
+static size_t tabla_capacidad(hash_tipo_t tipo, size_t tam){
+	return tipo == HASH_CERRADO ? tam * CARGA_MAX_CERRADO / 10 : tam * CARGA_MAX_ABIERTO;
+}
+
+// Menor tamaño, desde TAM_INICIAL, en el que entran cantidad elementos sin agrandar.
+static size_t tam_para(hash_tipo_t tipo, size_t cantidad){
+	size_t tam = TAM_INICIAL;
+	while (cantidad > tabla_capacidad(tipo, tam)){
+		tam *= FACTOR_REDIMENSION;
+	}
+	return tam;
+}
+
+// Pasa los pares del hash abierto a una tabla de tam baldes con pools nuevos,
+// que quedan del tamaño justo para los pares que hay. Si falta memoria no
+// cambia nada.
+static bool abierto_compactar(hash_t* hash, size_t tam){
+	pool_t* pares = hash->pares;
+	pool_t* eslabones = hash->eslabones;
+	tabla_t nueva;
+	// tabla_insertar crea las listas con hash->eslabones.
+	hash->pares = pool_crear(sizeof(nodo_t));
+	hash->eslabones = lista_pool_crear();
+	bool creada = hash->pares != NULL && hash->eslabones != NULL && tabla_crear(&nueva, HASH_ABIERTO, tam);
+	bool ok = creada;
+	for (size_t i = 0; ok && i < hash->tabla.tam; i++){
+		if (hash->tabla.listas[i] == NULL){
+			continue;
+		}
+		for (lista_pos_t pos = lista_pos_primera(hash->tabla.listas[i]); ok && pos != NULL; pos = lista_pos_siguiente(pos)){
+			nodo_t* nodo = pool_pedir(hash->pares);
+			ok = nodo != NULL;
+			if (ok){
+				*nodo = *(const nodo_t*) lista_pos_ver(pos);
+				ok = tabla_insertar(hash, &nueva, nodo) != NULL;
+			}
+		}
+	}
+	if (!ok){
+		if (creada){
+			for (size_t i = 0; i < nueva.tam; i++){
+				if (nueva.listas[i] != NULL){
+					lista_destruir(nueva.listas[i], NULL);
+				}
+			}
+			tabla_liberar(&nueva);
+		}
+		hash_pools_destruir(hash);
+		hash->pares = pares;
+		hash->eslabones = eslabones;
+		return false;
+	}
+	for (size_t i = 0; i < hash->tabla.tam; i++){
+		if (hash->tabla.listas[i] != NULL){
+			lista_destruir(hash->tabla.listas[i], NULL);
+		}
+	}
+	tabla_liberar(&hash->tabla);
+	hash->tabla = nueva;
+	pool_destruir(pares);
+	pool_destruir(eslabones);
+	if (tam != hash->tabla.tam){
+		hash->redimensiones++;
+	}
+	return true;
+}
+
+// Tamaño de la tabla de un cache de capacidad pares, con lugar para los borrados.
+static size_t cache_tam(size_t capacidad){
+	return tam_para(HASH_CERRADO, capacidad + capacidad / CACHE_HOLGURA);
+}
+
+static bool hay_que_agrandar(const hash_t* hash){
+	const tabla_t* tabla = &hash->tabla;
+	if (hash->tipo == HASH_CERRADO){
+		return (tabla->cant + tabla->borrados + 1) * 10 > tabla->tam * CARGA_MAX_CERRADO;
+	}
+	return tabla->cant + 1 > tabla->tam * CARGA_MAX_ABIERTO;
+}
+
+// Mientras haya una migración o iteradores no se achica: los dos cuentan con
+// que la tabla no cambie hasta que terminen.
+static bool hay_que_achicar(const hash_t* hash){
+	size_t tam = hash->tabla.tam;
+	return tam > hash->tam_minimo && !hash_migrando(hash) && hash->iteradores == 0
+		&& hash->tabla.cant * ACHICAR_DIVISOR < tabla_capacidad(hash->tipo, tam);
+}
+
+// Achica la tabla si quedó muy vacía. Si falta memoria para la más chica,
+// sigue con la actual.
+static void hash_achicar(hash_t* hash){
+	if (hay_que_achicar(hash)){
+		size_t tam_nuevo = tam_para(hash->tipo, hash->tabla.cant * 2);
+		hash_redimensionar(hash, tam_nuevo > hash->tam_minimo ? tam_nuevo : hash->tam_minimo);
+	}
+}
+
+// Busca la clave en la tabla y, si hay una migración en curso, en la vieja.
+static nodo_t* buscar_nodo(const hash_t* hash, const void* clave, size_t largo, uint64_t h){
+	nodo_t* nodo = tabla_buscar(hash, &hash->tabla, clave, largo, h);
+	if (nodo == NULL && hash_migrando(hash)){
+		nodo = tabla_buscar(hash, &hash->vieja, clave, largo, h);
+	}
+	return nodo;
+}
+
+// Busca la clave, siendo h su hash, y si no está inserta un par con esa
+// clave y dato NULL. Devuelve el nodo del par, o NULL si faltó memoria para
+// insertarlo. Salvo que haya que agrandar la tabla, la recorre una sola vez:
+// en el cerrado, la búsqueda ya deja la posición donde insertar.
+static nodo_t* buscar_o_insertar(hash_t* hash, const void* clave, size_t largo, uint64_t h, bool* insertado){
+	*insertado = false;
+	if (hash->mapa != NULL){
+		return NULL;
+	}
+	hash_migrar_paso(hash);
+	size_t libre = hash->tabla.tam;
+	nodo_t* nodo;
+	if (hash->tipo == HASH_CERRADO){
+		size_t pos = cerrado_buscar(hash, &hash->tabla, clave, largo, h, &libre);
+		nodo = pos < hash->tabla.tam ? &hash->tabla.nodos[pos] : NULL;
+	} else{
+		nodo = tabla_buscar(hash, &hash->tabla, clave, largo, h);
+	}
+	if (nodo == NULL && hash_migrando(hash)){
+		nodo = tabla_buscar(hash, &hash->vieja, clave, largo, h);
+	}
+	if (nodo != NULL && vencida(hash, clave, largo, h)){
+		// Vencido es como ausente: se saca, y la clave se guarda de nuevo.
+		void* dato;
+		par_borrar(hash, clave, largo, h, &dato);
+		if (hash->destruir_dato){
+			hash->destruir_dato(dato);
+		}
+		nodo = NULL;
+		libre = hash->tabla.tam;
+	}
+	if (nodo != NULL){
+		cache_usado(hash, nodo);
+		return nodo;
+	}
+
+	if (hash->cache.capacidad > 0 && hash->tabla.cant >= hash->cache.capacidad){
+		cache_desalojar(hash);
+	}
+	if (hay_que_agrandar(hash)){
+		size_t tam_nuevo = hash->tabla.tam * FACTOR_REDIMENSION;
+		// Si la mayoría de lo ocupado son borrados, alcanza con limpiarlos. Un
+		// cache que ya tiene el tamaño para su capacidad tampoco se agranda.
+		if (hash->tipo == HASH_CERRADO && (hash->tabla.borrados > hash->tabla.cant
+				|| (hash->cache.capacidad > 0 && hash->tabla.tam >= cache_tam(hash->cache.capacidad)))){
+			tam_nuevo = hash->tabla.tam;
+		}
+		if (!hash_redimensionar(hash, tam_nuevo)){
+			return NULL;
+		}
+		// La posición libre encontrada era de la tabla anterior.
+		libre = hash->tabla.tam;
+	}
+
+	nodo_t nuevo;
+	if (!nodo_iniciar(&nuevo, hash->claves, clave, largo, NULL, h)){
+		return NULL;
+	}
+	if (hash->tipo == HASH_CERRADO){
+		*insertado = true;
+		if (libre < hash->tabla.tam){
+			nodo = cerrado_ocupar(&hash->tabla, libre, &nuevo);
+		} else{
+			nodo = tabla_insertar(hash, &hash->tabla, &nuevo);
+		}
+		filtro_guardado(hash, h);
+		return nodo;
+	}
+	nodo = pool_pedir(hash->pares);
+	if (nodo != NULL){
+		*nodo = nuevo;
+		if (tabla_insertar(hash, &hash->tabla, nodo)){
+			*insertado = true;
+			filtro_guardado(hash, h);
+			return nodo;
+		}
+		pool_devolver(hash->pares, nodo);
+	}
+	clave_liberar(hash, largo);
+	return NULL;
+}
+
+// Guarda el par como hash_guardar, sin tocar el vencimiento de la clave.
+static bool guardar(hash_t* hash, const void* clave, size_t largo, uint64_t h, void* dato){
+	bool insertado;
+	nodo_t* nodo = buscar_o_insertar(hash, clave, largo, h, &insertado);
+	if (nodo == NULL){
+		return false;
+	}
+	if (!insertado && hash->destruir_dato){
+		hash->destruir_dato(nodo->dato);
+	}
+	nodo->dato = dato;
+	return true;
+}
+
+// ********** Lotes **********
+
+// Adelanta la lectura de lo primero que necesita la búsqueda de h en la tabla:
+// el grupo de control y la primera posición, o el balde. En el cerrado se leen
+// directamente: medido con tablas de 10M de claves, __builtin_prefetch sobre
+// esos arreglos no lograba superponer las lecturas y una lectura común sí.
+static void lote_anticipar_balde(const hash_t* hash, const tabla_t* tabla, uint64_t h){
+	size_t mascara = tabla->tam - 1;
+	if (hash->tipo == HASH_CERRADO){
+		size_t pos = H1(h) & mascara;
+		(void) *(volatile const uint8_t*) (tabla->ctrl + pos);
+		(void) *(volatile const uint64_t*) &tabla->nodos[pos].hash;
+	} else{
+		__builtin_prefetch(tabla->listas + (h & mascara));
+	}
+}
+
+// En el hash abierto, con el balde ya leído, adelanta la lectura de su lista.
+// En el cerrado no se adelanta la clave: revisar el grupo dos veces costaba
+// más de lo que se ganaba.
+static void lote_anticipar_lista(const tabla_t* tabla, uint64_t h){
+	lista_t* lista = tabla->listas[h & (tabla->tam - 1)];
+	if (lista != NULL){
+		__builtin_prefetch(lista);
+	}
+}
+
+// En el hash abierto, adelanta la lectura del primer par de la lista.
+static void lote_anticipar_par(const tabla_t* tabla, uint64_t h){
+	lista_t* lista = tabla->listas[h & (tabla->tam - 1)];
+	if (lista != NULL && !lista_esta_vacia(lista)){
+		nodo_t* nodo = lista_ver_primero(lista);
+		__builtin_prefetch(nodo);
+	}
+}
+
+// Calcula el hash de cada clave del lote y adelanta, por etapas, la lectura
+// de lo que van a necesitar sus búsquedas. Cada etapa recorre todo el lote
+// antes de pasar a la siguiente, así las lecturas de las distintas claves se
+// superponen en lugar de esperarse una a otra.
+static void lote_preparar(const hash_t* hash, const char* const claves[], size_t n, size_t largos[], uint64_t hashes[]){
+	for (size_t i = 0; i < n; i++){
+		largos[i] = strlen(claves[i]);
+		hashes[i] = funcion_hash(hash, claves[i], largos[i]);
+		lote_anticipar_balde(hash, &hash->tabla, hashes[i]);
+	}
+	if (hash->tipo == HASH_CERRADO){
+		return;
+	}
+	for (size_t i = 0; i < n; i++){
+		lote_anticipar_lista(&hash->tabla, hashes[i]);
+	}
+	for (size_t i = 0; i < n; i++){
+		lote_anticipar_par(&hash->tabla, hashes[i]);
+	}
+}
+
+// ********** Hilos **********
+
+static size_t hilos_por_defecto(void){
+	long procesadores = sysconf(_SC_NPROCESSORS_ONLN);
+	return procesadores > 0 ? (size_t) procesadores : 1;
+}
+
+// Corre funcion sobre cada uno de los cantidad trabajos contiguos de
+// tam_trabajo bytes: el primero en este hilo y el resto en hilos nuevos. Si
+// no se puede crear un hilo, ese trabajo también corre en este.
+static void ejecutar_en_paralelo(void* trabajos, size_t tam_trabajo, size_t cantidad, void* (*funcion)(void*)){
+	pthread_t* hilos = malloc(cantidad * sizeof(pthread_t));
+	bool* lanzados = calloc(cantidad, sizeof(bool));
+	for (size_t i = 1; i < cantidad && hilos != NULL && lanzados != NULL; i++){
+		lanzados[i] = pthread_create(&hilos[i], NULL, funcion, (char*) trabajos + i * tam_trabajo) == 0;
+	}
+	for (size_t i = 0; i < cantidad; i++){
+		if (lanzados != NULL && lanzados[i]){
+			pthread_join(hilos[i], NULL);
+		} else{
+			funcion((char*) trabajos + i * tam_trabajo);
+		}
+	}
+	free(hilos);
+	free(lanzados);
+}
+
+// ********** Construcción en paralelo **********
+
+static size_t construir_balde(const hash_t* hash, uint64_t h){
+	size_t mascara = hash->tabla.tam - 1;
+	return hash->tipo == HASH_CERRADO ? H1(h) & mascara : (size_t) h & mascara;
+}
+
+static size_t construir_particion(const construccion_t* construccion, uint64_t h){
+	return construir_balde(construccion->hash, h) >> construccion->desplazamiento;
+}
+
+// Claves [desde, hasta) que le tocan al trabajador en las dos primeras etapas.
+static void construir_rango(const trabajador_t* trabajador, size_t* desde, size_t* hasta){
+	const construccion_t* construccion = trabajador->construccion;
+	*desde = construccion->n * trabajador->numero / construccion->hilos;
+	*hasta = construccion->n * (trabajador->numero + 1) / construccion->hilos;
+}
+
+// Primera etapa: calcula el hash de cada clave propia y cuenta cuántas caen
+// en cada partición.
+static void* construir_hashear(void* extra){
+	trabajador_t* trabajador = extra;
+	construccion_t* construccion = trabajador->construccion;
+	size_t desde, hasta;
+	construir_rango(trabajador, &desde, &hasta);
+	for (size_t i = desde; i < hasta; i++){
+		construccion->largos[i] = strlen(construccion->claves[i]);
+		construccion->hashes[i] = funcion_hash(construccion->hash, construccion->claves[i], construccion->largos[i]);
+		trabajador->cuentas[construir_particion(construccion, construccion->hashes[i])]++;
+	}
+	return NULL;
+}
+
+// Segunda etapa: ubica los índices propios en su partición. Como cada hilo
+// tiene un rango contiguo de claves y escribe después que los anteriores,
+// dentro de una partición las claves quedan en el orden original.
+static void* construir_repartir(void* extra){
+	trabajador_t* trabajador = extra;
+	construccion_t* construccion = trabajador->construccion;
+	size_t desde, hasta;
+	construir_rango(trabajador, &desde, &hasta);
+	for (size_t i = desde; i < hasta; i++){
+		construccion->orden[trabajador->cuentas[construir_particion(construccion, construccion->hashes[i])]++] = i;
+	}
+	return NULL;
+}
+
+// Una clave repetida reemplaza al dato anterior, igual que en hash_guardar.
+static void construir_reemplazar(const hash_t* hash, nodo_t* nodo, void* dato){
+	if (hash->destruir_dato){
+		hash->destruir_dato(nodo->dato);
+	}
+	nodo->dato = dato;
+}
+
+static void construir_abierto(trabajador_t* trabajador, size_t i){
+	construccion_t* construccion = trabajador->construccion;
+	hash_t* hash = construccion->hash;
+	const char* clave = construccion->claves[i];
+	size_t largo = construccion->largos[i];
+	uint64_t h = construccion->hashes[i];
+	// Sólo lee el balde de la clave, que es de esta partición.
+	nodo_t* nodo = tabla_buscar(hash, &hash->tabla, clave, largo, h);
+	if (nodo != NULL){
+		construir_reemplazar(hash, nodo, construccion->datos[i]);
+		return;
+	}
+	lista_t** lista = &hash->tabla.listas[construir_balde(hash, h)];
+	if (*lista == NULL){
+		*lista = lista_crear_con_pool(trabajador->eslabones);
+	}
+	nodo = pool_pedir(trabajador->pares);
+	if (*lista == NULL || nodo == NULL){
+		trabajador->ok = false;
+		return;
+	}
+	if (!nodo_iniciar(nodo, trabajador->claves, clave, largo, construccion->datos[i], h)
+			|| !lista_insertar_primero(*lista, nodo)){
+		pool_devolver(trabajador->pares, nodo);
+		trabajador->ok = false;
+		return;
+	}
+	// Las particiones tienen al menos 64 baldes y empiezan en múltiplos de
+	// 64, así que cada hilo escribe palabras distintas del mapa.
+	ocupados_marcar(&hash->tabla, construir_balde(hash, h));
+	trabajador->insertados++;
+}
+
+// Guarda la clave en la primera posición vacía desde la suya, como lo haría
+// tabla_insertar sin borrados, siempre que no pase de fin (el final de la
+// partición). Devuelve false si hay que dejarla para el final.
+static bool construir_cerrado(trabajador_t* trabajador, size_t i, size_t fin){
+	construccion_t* construccion = trabajador->construccion;
+	hash_t* hash = construccion->hash;
+	tabla_t* tabla = &hash->tabla;
+	const char* clave = construccion->claves[i];
+	size_t largo = construccion->largos[i];
+	uint64_t h = construccion->hashes[i];
+	for (size_t pos = construir_balde(hash, h); pos < fin; pos++){
+		if (tabla->ctrl[pos] == CTRL_VACIO){
+			nodo_t nodo;
+			if (!nodo_iniciar(&nodo, trabajador->claves, clave, largo, construccion->datos[i], h)){
+				trabajador->ok = false;
+				return true;
+			}
+			// Sólo escribe la copia del final del arreglo de control si pos es
+			// de la primera partición.
+			ctrl_asignar(tabla, pos, H2(h));
+			tabla->nodos[pos] = nodo;
+			trabajador->insertados++;
+			return true;
+		}
+		if (tabla->ctrl[pos] == H2(h) && clave_igual(&tabla->nodos[pos], clave, largo, h)){
+			construir_reemplazar(hash, &tabla->nodos[pos], construccion->datos[i]);
+			return true;
+		}
+	}
+	return false;
+}
+
+// Tercera etapa: guarda las claves de las particiones del trabajador.
+static void* construir_llenar(void* extra){
+	trabajador_t* trabajador = extra;
+	construccion_t* construccion = trabajador->construccion;
+	hash_t* hash = construccion->hash;
+	for (size_t p = trabajador->numero; p < construccion->particiones && trabajador->ok; p += construccion->hilos){
+		size_t primer_balde = p << construccion->desplazamiento;
+		size_t fin = (p + 1) << construccion->desplazamiento;
+		size_t diferidas = 0;
+		for (size_t j = construccion->inicios[p]; j < construccion->inicios[p + 1] && trabajador->ok; j++){
+			size_t i = construccion->orden[j];
+			if (hash->tipo == HASH_ABIERTO){
+				construir_abierto(trabajador, i);
+			} else if (!construir_cerrado(trabajador, i, fin)){
+				// Las diferidas se compactan al principio de la partición, en orden.
+				construccion->orden[construccion->inicios[p] + diferidas++] = i;
+			}
+		}
+		construccion->diferidas[p] = diferidas;
+		if (hash->tipo == HASH_ABIERTO){
+			for (size_t b = primer_balde; b < fin; b++){
+				if (hash->tabla.listas[b] != NULL){
+					lista_cambiar_pool(hash->tabla.listas[b], hash->eslabones);
+				}
+			}
+		}
+	}
+	return NULL;
 }
 
-//Busca un nodo dentro de la tabla hash.
-nodo_t* buscar_nodo(const hash_t* hash; char* clave);
+// Pasa las claves, pares y nodos de lista de los trabajadores al hash.
+// Devuelve false si alguno no pudo terminar su parte.
+static bool construir_fusionar(hash_t* hash, trabajador_t* trabajadores, size_t hilos){
+	bool ok = true;
+	for (size_t i = 0; i < hilos; i++){
+		trabajador_t* trabajador = &trabajadores[i];
+		ok = ok && trabajador->ok;
+		hash->tabla.cant += trabajador->insertados;
+		if (trabajador->claves != NULL){
+			arena_fusionar(hash->claves, trabajador->claves);
+		}
+		if (trabajador->pares != NULL){
+			pool_fusionar(hash->pares, trabajador->pares);
+		}
+		if (trabajador->eslabones != NULL){
+			pool_fusionar(hash->eslabones, trabajador->eslabones);
+		}
+	}
+	return ok;
+}
+
+// Reparte la tabla en particiones de baldes contiguos y prepara los
+// arreglos auxiliares. Devuelve false si no hay memoria.
+static bool construccion_crear(construccion_t* construccion, size_t hilos){
+	size_t tam = construccion->hash->tabla.tam;
+	size_t particiones = 1;
+	while (particiones < hilos * CONSTRUIR_PARTICIONES_POR_HILO
+			&& particiones * 2 * CONSTRUIR_BALDES_POR_PARTICION <= tam){
+		particiones *= 2;
+	}
+	construccion->particiones = particiones;
+	construccion->desplazamiento = 0;
+	while ((particiones << construccion->desplazamiento) < tam){
+		construccion->desplazamiento++;
+	}
+	construccion->hilos = hilos;
+	construccion->largos = malloc(construccion->n * sizeof(size_t));
+	construccion->hashes = malloc(construccion->n * sizeof(uint64_t));
+	construccion->orden = malloc(construccion->n * sizeof(size_t));
+	construccion->inicios = malloc((particiones + 1) * sizeof(size_t));
+	construccion->diferidas = calloc(particiones, sizeof(size_t));
+	return construccion->largos != NULL && construccion->hashes != NULL && construccion->orden != NULL
+		&& construccion->inicios != NULL && construccion->diferidas != NULL;
+}
+
+static void construccion_liberar(construccion_t* construccion){
+	free(construccion->largos);
+	free(construccion->hashes);
+	free(construccion->orden);
+	free(construccion->inicios);
+	free(construccion->diferidas);
+}
+
+// Crea los trabajadores, con sus contadores y sus arenas y pools propios.
+static trabajador_t* trabajadores_crear(construccion_t* construccion, size_t hilos, size_t** cuentas){
+	trabajador_t* trabajadores = calloc(hilos, sizeof(trabajador_t));
+	*cuentas = calloc(hilos * construccion->particiones, sizeof(size_t));
+	if (trabajadores == NULL || *cuentas == NULL){
+		free(trabajadores);
+		free(*cuentas);
+		return NULL;
+	}
+	bool abierto = construccion->hash->tipo == HASH_ABIERTO;
+	for (size_t i = 0; i < hilos; i++){
+		trabajador_t* trabajador = &trabajadores[i];
+		trabajador->construccion = construccion;
+		trabajador->numero = i;
+		trabajador->cuentas = *cuentas + i * construccion->particiones;
+		trabajador->claves = arena_crear();
+		trabajador->pares = abierto ? pool_crear(sizeof(nodo_t)) : NULL;
+		trabajador->eslabones = abierto ? lista_pool_crear() : NULL;
+		trabajador->ok = trabajador->claves != NULL && (!abierto || (trabajador->pares != NULL && trabajador->eslabones != NULL));
+	}
+	return trabajadores;
+}
+
+// Convierte las cuentas por trabajador y partición en la posición de orden
+// donde cada trabajador empieza a escribir cada partición.
+static void construir_acumular(construccion_t* construccion, trabajador_t* trabajadores){
+	size_t posicion = 0;
+	for (size_t p = 0; p < construccion->particiones; p++){
+		construccion->inicios[p] = posicion;
+		for (size_t i = 0; i < construccion->hilos; i++){
+			size_t cuenta = trabajadores[i].cuentas[p];
+			trabajadores[i].cuentas[p] = posicion;
+			posicion += cuenta;
+		}
+	}
+	construccion->inicios[construccion->particiones] = posicion;
+}
+
+// Guarda, en el orden original, las claves del hash cerrado cuyo recorrido
+// se salía de su partición.
+static bool construir_diferidas(construccion_t* construccion){
+	hash_t* hash = construccion->hash;
+	for (size_t p = 0; p < construccion->particiones; p++){
+		for (size_t j = 0; j < construccion->diferidas[p]; j++){
+			size_t i = construccion->orden[construccion->inicios[p] + j];
+			bool insertado;
+			nodo_t* nodo = buscar_o_insertar(hash, construccion->claves[i], construccion->largos[i], construccion->hashes[i], &insertado);
+			if (nodo == NULL){
+				return false;
+			}
+			if (insertado){
+				nodo->dato = construccion->datos[i];
+			} else{
+				construir_reemplazar(hash, nodo, construccion->datos[i]);
+			}
+		}
+	}
+	return true;
+}
 
+// ********** Imágenes **********
+
+// Igual que cerrado_buscar, sobre las ranuras de la imagen. Devuelve tam si
+// la clave no está.
+static size_t mapa_buscar(const hash_t* hash, const void* clave, size_t largo, uint64_t h){
+	const tabla_t* tabla = &hash->tabla;
+	const mapa_t* mapa = hash->mapa;
+	size_t mascara = tabla->tam - 1;
+	size_t pos = H1(h) & mascara;
+	while (true){
+		grupo_t grupo = hash->grupo_revisar(tabla->ctrl + pos, H2(h));
+		while (grupo.coincidencias){
+			size_t i = (pos + (size_t) __builtin_ctz(grupo.coincidencias)) & mascara;
+			const ranura_t* ranura = &mapa->ranuras[i];
+			if (ranura->hash == h && ranura->largo == largo && memcmp(mapa->claves + ranura->clave, clave, largo) == 0){
+				return i;
+			}
+			grupo.coincidencias &= grupo.coincidencias - 1;
+		}
+		if (grupo.vacios){
+			return tabla->tam;
+		}
+		pos = (pos + hash->ancho_grupo) & mascara;
+	}
+}
+
+// Arreglos de la imagen, armados en memoria antes de escribirse.
+typedef struct volcado{
+	uint8_t* ctrl;
+	ranura_t* ranuras;
+	uint64_t tam;
+	uint64_t largo_claves;
+} volcado_t;
+
+// Ubica cada par en la primera posición vacía desde la suya, como
+// tabla_insertar sin borrados, y asigna los desplazamientos de las claves en
+// el orden del iterador.
+static bool volcado_armar(const hash_t* hash, volcado_t* volcado){
+	size_t cantidad = hash_cantidad(hash);
+	volcado->tam = TAM_INICIAL;
+	while (cantidad * 10 > volcado->tam * CARGA_MAX_CERRADO){
+		volcado->tam *= FACTOR_REDIMENSION;
+	}
+	volcado->ctrl = malloc(volcado->tam + GRUPO_MAX);
+	volcado->ranuras = calloc(volcado->tam, sizeof(ranura_t));
+	if (volcado->ctrl == NULL || volcado->ranuras == NULL){
+		return false;
+	}
+	memset(volcado->ctrl, CTRL_VACIO, volcado->tam + GRUPO_MAX);
+	volcado->largo_claves = 0;
+	size_t mascara = volcado->tam - 1;
+	hash_iter_t iter;
+	for (hash_iter_iniciar(&iter, hash); !hash_iter_al_final(&iter); hash_iter_avanzar(&iter)){
+		size_t largo = hash_iter_ver_largo(&iter);
+		const void* dato = hash_iter_ver_dato(&iter);
+		uint64_t h = hash_funcion_wyhash(hash_iter_ver_actual(&iter), largo, hash->semilla);
+		size_t pos = H1(h) & mascara;
+		while (volcado->ctrl[pos] != CTRL_VACIO){
+			pos = (pos + 1) & mascara;
+		}
+		volcado->ctrl[pos] = H2(h);
+		if (pos < GRUPO_MAX){
+			volcado->ctrl[volcado->tam + pos] = H2(h);
+		}
+		volcado->ranuras[pos] = (ranura_t) {volcado->largo_claves, largo, (uint64_t) (uintptr_t) dato, h};
+		volcado->largo_claves += largo + 1;
+	}
+	hash_iter_finalizar(&iter);
+	return true;
+}
+
+static uint64_t alinear8(uint64_t n){
+	return (n + 7) / 8 * 8;
+}
+
+// Escribe largo bytes en cero (menos de 8) para alinear lo que sigue.
+static bool volcado_rellenar(FILE* archivo, size_t largo){
+	static const char relleno[8] = {0};
+	return largo == 0 || fwrite(relleno, largo, 1, archivo) == 1;
+}
+
+// Escribe la imagen completa. Las claves se recorren de nuevo en el mismo
+// orden que en volcado_armar.
+static bool volcado_escribir(const hash_t* hash, const volcado_t* volcado, FILE* archivo){
+	imagen_cabecera_t cabecera;
+	memset(&cabecera, 0, sizeof(cabecera));
+	memcpy(cabecera.magia, IMAGEN_MAGIA, sizeof(cabecera.magia));
+	cabecera.orden = IMAGEN_ORDEN;
+	cabecera.semilla = hash->semilla;
+	cabecera.cantidad = hash_cantidad(hash);
+	cabecera.tam = volcado->tam;
+	cabecera.ctrl = alinear8(sizeof(cabecera));
+	cabecera.ranuras = alinear8(cabecera.ctrl + volcado->tam + GRUPO_MAX);
+	cabecera.claves = cabecera.ranuras + volcado->tam * sizeof(ranura_t);
+	cabecera.largo_claves = volcado->largo_claves;
+	bool ok = fwrite(&cabecera, sizeof(cabecera), 1, archivo) == 1
+		&& volcado_rellenar(archivo, cabecera.ctrl - sizeof(cabecera))
+		&& fwrite(volcado->ctrl, volcado->tam + GRUPO_MAX, 1, archivo) == 1
+		&& volcado_rellenar(archivo, cabecera.ranuras - cabecera.ctrl - volcado->tam - GRUPO_MAX)
+		&& fwrite(volcado->ranuras, sizeof(ranura_t), volcado->tam, archivo) == volcado->tam;
+	hash_iter_t iter;
+	for (hash_iter_iniciar(&iter, hash); ok && !hash_iter_al_final(&iter); hash_iter_avanzar(&iter)){
+		ok = fwrite(hash_iter_ver_actual(&iter), hash_iter_ver_largo(&iter) + 1, 1, archivo) == 1;
+	}
+	hash_iter_finalizar(&iter);
+	return ok;
+}
+
+// Verifica que la cabecera describa una imagen que entra en largo bytes.
+// No revisa cada ranura: la imagen tiene que venir de hash_volcar.
+static bool imagen_es_valida(const imagen_cabecera_t* cabecera, size_t largo){
+	uint64_t tam = cabecera->tam;
+	return memcmp(cabecera->magia, IMAGEN_MAGIA, sizeof(cabecera->magia)) == 0
+		&& cabecera->orden == IMAGEN_ORDEN
+		&& tam >= GRUPO_MAX && (tam & (tam - 1)) == 0 && tam <= largo
+		&& cabecera->cantidad < tam
+		&& cabecera->ctrl >= sizeof(imagen_cabecera_t)
+		&& cabecera->ranuras >= cabecera->ctrl + tam + GRUPO_MAX && cabecera->ranuras % 8 == 0
+		&& cabecera->claves == cabecera->ranuras + tam * sizeof(ranura_t)
+		&& cabecera->claves <= largo && cabecera->largo_claves <= largo - cabecera->claves;
+}
+
+// ********** Estadísticas **********
+
+static void histograma_sumar(hash_estadisticas_t* estadisticas, size_t largo){
+	estadisticas->histograma[largo < HASH_ESTADISTICAS_LARGOS ? largo : HASH_ESTADISTICAS_LARGOS - 1]++;
+}
+
+// Agrega los largos y distancias de tabla. Devuelve la suma de las distancias.
+static size_t tabla_estadisticas(const hash_t* hash, const tabla_t* tabla, hash_estadisticas_t* estadisticas){
+	size_t suma = 0;
+	size_t distancia_maxima = estadisticas->distancia_maxima;
+	if (hash->tipo == HASH_ABIERTO){
+		for (size_t i = 0; i < tabla->tam; i++){
+			size_t largo = tabla->listas[i] ? lista_largo(tabla->listas[i]) : 0;
+			histograma_sumar(estadisticas, largo);
+			if (tabla->listas[i]){
+				estadisticas->bytes_listas += lista_tam();
+			}
+			if (largo == 0){
+				continue;
+			}
+			// Los pares de una lista de largo n están a distancias 0..n-1.
+			suma += largo * (largo - 1) / 2;
+			if (largo - 1 > distancia_maxima){
+				distancia_maxima = largo - 1;
+			}
+		}
+	} else{
+		size_t mascara = tabla->tam - 1;
+		for (size_t i = 0; i < tabla->tam; i++){
+			if (CTRL_ES_LIBRE(tabla->ctrl[i])){
+				continue;
+			}
+			uint64_t h = hash->mapa ? hash->mapa->ranuras[i].hash : tabla->nodos[i].hash;
+			size_t distancia = (i - H1(h)) & mascara;
+			histograma_sumar(estadisticas, distancia);
+			suma += distancia;
+			if (distancia > distancia_maxima){
+				distancia_maxima = distancia;
+			}
+		}
+	}
+	estadisticas->distancia_maxima = distancia_maxima;
+	return suma;
+}
+
+static size_t tabla_bytes(hash_tipo_t tipo, const tabla_t* tabla){
+	if (tabla->tam == 0){
+		return 0;
+	}
+	if (tipo == HASH_CERRADO){
+		return tabla->tam * sizeof(nodo_t) + tabla->tam + GRUPO_MAX;
+	}
+	return tabla->tam * sizeof(lista_t*) + (tabla->tam + 63) / 64 * sizeof(uint64_t);
+}
+
+// ********** Recorrido interno **********
+
+static void visita_par(visita_t* visita, const char* clave, void* dato){
+	if (visita->cortar != NULL && atomic_load_explicit(visita->cortar, memory_order_relaxed)){
+		visita->seguir = false;
+		return;
+	}
+	visita->seguir = visita->visitar(clave, dato, visita->extra);
+	if (!visita->seguir && visita->cortar != NULL){
+		atomic_store_explicit(visita->cortar, true, memory_order_relaxed);
+	}
+}
+
+// Visitar de lista_iterar: pasa el par al visitar del usuario.
+static bool visitar_par(void* dato, void* extra){
+	visita_t* visita = extra;
+	const nodo_t* nodo = dato;
+	visita_par(visita, nodo_clave(nodo), nodo->dato);
+	return visita->seguir;
+}
+
+// Visita los pares de los baldes [desde, hasta) de la tabla. Devuelve false
+// si hay que cortar el recorrido.
+static bool tabla_visitar(const hash_t* hash, const tabla_t* tabla, size_t desde, size_t hasta, visita_t* visita){
+	for (size_t i = tabla_proximo_ocupado(hash, tabla, desde); i < hasta && visita->seguir;
+			i = tabla_proximo_ocupado(hash, tabla, i + 1)){
+		if (hash->mapa != NULL){
+			const ranura_t* ranura = &hash->mapa->ranuras[i];
+			visita_par(visita, hash->mapa->claves + ranura->clave, (void*) (uintptr_t) ranura->dato);
+		} else if (hash->tipo == HASH_CERRADO){
+			visita_par(visita, nodo_clave(&tabla->nodos[i]), tabla->nodos[i].dato);
+		} else{
+			lista_iterar(tabla->listas[i], visitar_par, visita);
+		}
+	}
+	return visita->seguir;
+}
+
+static void* recorrido_visitar(void* extra){
+	recorrido_t* recorrido = extra;
+	const hash_t* hash = recorrido->hash;
+	size_t tam_vieja = hash->vieja.tam;
+	if (recorrido->desde < tam_vieja){
+		size_t hasta = recorrido->hasta < tam_vieja ? recorrido->hasta : tam_vieja;
+		if (!tabla_visitar(hash, &hash->vieja, recorrido->desde, hasta, &recorrido->visita)){
+			return NULL;
+		}
+	}
+	if (recorrido->hasta > tam_vieja){
+		size_t desde = recorrido->desde > tam_vieja ? recorrido->desde - tam_vieja : 0;
+		tabla_visitar(hash, &hash->tabla, desde, recorrido->hasta - tam_vieja, &recorrido->visita);
+	}
+	return NULL;
+}
+
+// ********** Iterador (auxiliares) **********
+
+// Deja el iterador en el primer par a partir de (tabla, indice), pasando de
+// la tabla vieja a la actual cuando corresponde.
+static void iter_buscar_siguiente(hash_iter_t* iter){
+	const hash_t* hash = iter->hash;
+	while (true){
+		const tabla_t* tabla = iter->tabla;
+		iter->indice = tabla_proximo_ocupado(hash, tabla, iter->indice);
+		if (iter->indice < tabla->tam){
+			if (hash->tipo == HASH_ABIERTO){
+				iter->posicion = lista_pos_primera(tabla->listas[iter->indice]);
+			}
+			return;
+		}
+		if (tabla == &hash->tabla){
+			return;
+		}
+		iter->tabla = &hash->tabla;
+		iter->indice = 0;
+	}
+}
+
+// ********** Funciones de hashing **********
+
+// Ver wyhash.h.
+uint64_t hash_funcion_wyhash(const void *clave, size_t largo, uint64_t semilla){
+	return wyhash(clave, largo, semilla);
+}
+
+// djb2 (www.cse.yorku.ca/~oz/hash.html) partiendo de la semilla, con la mezcla
+// final de MurmurHash3 para que los bits bajos, que son los que eligen el
+// balde, no queden correlacionados entre claves parecidas.
+uint64_t hash_funcion_djb2(const void *clave, size_t largo, uint64_t semilla){
+	const unsigned char* str = clave;
+	uint64_t hash = 5381 ^ semilla;
+	for (size_t i = 0; i < largo; i++){
+		hash = ((hash << 5) + hash) + str[i];
+	}
+	return mezclar(hash);
+}
 
 // ********** Primitivas **********
 
-hash_t *hash_crear(hash_destruir_dato_t destruir_dato);
-
-/* Guarda un elemento en el hash, si la clave ya se encuentra en la
- * estructura, la reemplaza. De no poder guardarlo devuelve false.
- * Pre: La estructura hash fue inicializada
- * Post: Se almacenó el par (clave, dato)
- */
-bool hash_guardar(hash_t *hash, const char *clave, void *dato);
-
-/* Borra un elemento del hash y devuelve el dato asociado.  Devuelve
- * NULL si el dato no estaba.
- * Pre: La estructura hash fue inicializada
- * Post: El elemento fue borrado de la estructura y se lo devolvió,
- * en el caso de que estuviera guardado.
- */
-void *hash_borrar(hash_t *hash, const char *clave);
-
-/* Obtiene el valor de un elemento del hash, si la clave no se encuentra
- * devuelve NULL.
- * Pre: La estructura hash fue inicializada
- */
-void *hash_obtener(const hash_t *hash, const char *clave);
-
-/* Determina si clave pertenece o no al hash.
- * Pre: La estructura hash fue inicializada
- */
-bool hash_pertenece(const hash_t *hash, const char *clave);
-
-/* Devuelve la cantidad de elementos del hash.
- * Pre: La estructura hash fue inicializada
- */
-size_t hash_cantidad(const hash_t *hash);
-
-/* Destruye la estructura liberando la memoria pedida y llamando a la función
- * destruir para cada par (clave, dato).
- * Pre: La estructura hash fue inicializada
- * Post: La estructura hash fue destruida
- */
-void hash_destruir(hash_t *hash);
+hash_t *hash_crear_con_funcion(hash_destruir_dato_t destruir_dato, hash_tipo_t tipo, hash_funcion_t funcion){
+	hash_t* hash = hash_crear_con_semilla(destruir_dato, tipo, funcion, 0);
+	if (hash != NULL){
+		hash->semilla = semilla_nueva(hash);
+	}
+	return hash;
+}
+
+hash_t *hash_crear_con_semilla(hash_destruir_dato_t destruir_dato, hash_tipo_t tipo, hash_funcion_t funcion, uint64_t semilla){
+	hash_t* hash = malloc(sizeof(hash_t));
+	if (hash == NULL){
+		return NULL;
+	}
+	hash->tipo = tipo;
+	hash->funcion = funcion ? funcion : hash_funcion_wyhash;
+	hash->semilla = semilla;
+	hash->pares = NULL;
+	hash->eslabones = NULL;
+	hash->mapa = NULL;
+	hash->redimensiones = 0;
+	hash->tam_minimo = TAM_INICIAL;
+	hash->filtrado = (filtrado_t) {NULL, 0, 0, 0, 0};
+	hash->cache = (cache_t) {0, 0, 0, 0, 0};
+	hash->vencimientos = NULL;
+	hash->reloj = hash_reloj_ms;
+	hash->claves = arena_crear();
+	if (hash->claves == NULL){
+		free(hash);
+		return NULL;
+	}
+	if (tipo == HASH_ABIERTO){
+		hash->pares = pool_crear(sizeof(nodo_t));
+		hash->eslabones = lista_pool_crear();
+	}
+	if ((tipo == HASH_ABIERTO && (hash->pares == NULL || hash->eslabones == NULL))
+			|| !tabla_crear(&hash->tabla, tipo, TAM_INICIAL)){
+		hash_pools_destruir(hash);
+		arena_destruir(hash->claves);
+		free(hash);
+		return NULL;
+	}
+	hash->vieja.listas = NULL;
+	hash->vieja.nodos = NULL;
+	hash->vieja.ctrl = NULL;
+	hash->vieja.ocupados = NULL;
+	hash->vieja.referencias = NULL;
+	hash->vieja.tam = 0;
+	hash->vieja.cant = 0;
+	hash->vieja.borrados = 0;
+	hash->migrado = 0;
+	hash->incremental = false;
+	hash->iteradores = 0;
+	grupo_elegir(hash);
+	hash->destruir_dato = destruir_dato;
+	return hash;
+}
+
+hash_t *hash_crear_con_tipo(hash_destruir_dato_t destruir_dato, hash_tipo_t tipo){
+	return hash_crear_con_funcion(destruir_dato, tipo, NULL);
+}
+
+hash_t *hash_crear(hash_destruir_dato_t destruir_dato){
+	return hash_crear_con_tipo(destruir_dato, HASH_ABIERTO);
+}
+
+hash_t *hash_crear_cache(size_t capacidad, hash_destruir_dato_t destruir_dato){
+	if (capacidad == 0){
+		return NULL;
+	}
+	hash_t* hash = hash_crear_con_tipo(destruir_dato, HASH_CERRADO);
+	if (hash == NULL){
+		return NULL;
+	}
+	hash->cache.capacidad = capacidad;
+	// El tamaño final de una vez, como en hash_construir.
+	tabla_t tabla;
+	if (!hash_tabla_crear(hash, &tabla, cache_tam(capacidad))){
+		hash_destruir(hash);
+		return NULL;
+	}
+	tabla_liberar(&hash->tabla);
+	hash->tabla = tabla;
+	hash->tam_minimo = tabla.tam;
+	return hash;
+}
+
+bool hash_redimension_incremental(hash_t *hash, bool activar){
+	if (activar && hash->cache.capacidad > 0){
+		return false;
+	}
+	hash->incremental = activar;
+	if (!activar && hash_migrando(hash)){
+		return hash_migrar(hash, hash->vieja.tam);
+	}
+	return true;
+}
+
+uint64_t hash_calcular(const hash_t *hash, const void *clave, size_t largo){
+	return funcion_hash(hash, clave, largo);
+}
+
+bool hash_guardar_n(hash_t *hash, const void *clave, size_t largo, void *dato){
+	return hash_guardar_con_hash(hash, clave, largo, funcion_hash(hash, clave, largo), dato);
+}
+
+bool hash_guardar_con_hash(hash_t *hash, const void *clave, size_t largo, uint64_t h, void *dato){
+	if (!guardar(hash, clave, largo, h, dato)){
+		return false;
+	}
+	vencimiento_descartar(hash, clave, largo, h);
+	return true;
+}
+
+bool hash_guardar_con_ttl_n(hash_t *hash, const void *clave, size_t largo, void *dato, uint64_t ttl){
+	if (hash->mapa != NULL){
+		return false;
+	}
+	uint64_t ahora = hash->reloj();
+	if (hash->vencimientos == NULL && !vencimientos_crear(hash, ahora)){
+		return false;
+	}
+	uint64_t h = funcion_hash(hash, clave, largo);
+	vencimientos_t* vencimientos = hash->vencimientos;
+	vigencia_t* vigencia = vigencia_buscar(hash, clave, largo, h);
+	bool nueva = vigencia == NULL;
+	uint64_t anterior = 0;
+	if (!nueva){
+		anterior = rueda_vencimiento(&vigencia->temporizador);
+		rueda_quitar(vencimientos->rueda, &vigencia->temporizador);
+	} else{
+		// Lo que puede fallar del índice se hace antes de guardar, que al
+		// reemplazar destruye el dato anterior y ya no se puede deshacer.
+		vigencia = malloc(sizeof(vigencia_t) + largo);
+		if (vigencia == NULL){
+			return false;
+		}
+		vigencia->hash = h;
+		vigencia->largo = largo;
+		memcpy(vigencia->clave, clave, largo);
+		vigencia->sig = hash_u64_obtener(vencimientos->indice, h);
+		if (!hash_u64_guardar(vencimientos->indice, h, vigencia)){
+			free(vigencia);
+			return false;
+		}
+	}
+	// Mientras se guarda no vence: si la clave estaba vencida, guardar le
+	// reemplaza el dato en vez de borrarla junto con su vigencia.
+	rueda_agregar(vencimientos->rueda, &vigencia->temporizador, UINT64_MAX);
+	bool guardado = guardar(hash, clave, largo, h, dato);
+	rueda_quitar(vencimientos->rueda, &vigencia->temporizador);
+	if (!guardado){
+		if (nueva){
+			vigencia_desindexar(hash, vigencia);
+			free(vigencia);
+		} else{
+			rueda_agregar(vencimientos->rueda, &vigencia->temporizador, anterior);
+		}
+		return false;
+	}
+	uint64_t vence = ttl > UINT64_MAX - ahora ? UINT64_MAX : ahora + ttl;
+	rueda_agregar(vencimientos->rueda, &vigencia->temporizador, vence);
+	return true;
+}
+
+void **hash_obtener_o_insertar_n(hash_t *hash, const void *clave, size_t largo, bool *insertado){
+	bool nuevo;
+	nodo_t* nodo = buscar_o_insertar(hash, clave, largo, funcion_hash(hash, clave, largo), &nuevo);
+	if (insertado != NULL){
+		*insertado = nuevo;
+	}
+	return nodo ? &nodo->dato : NULL;
+}
+
+bool hash_actualizar_n(hash_t *hash, const void *clave, size_t largo, hash_actualizar_dato_t actualizar, void *extra){
+	bool insertado;
+	nodo_t* nodo = buscar_o_insertar(hash, clave, largo, funcion_hash(hash, clave, largo), &insertado);
+	if (nodo == NULL){
+		return false;
+	}
+	nodo->dato = actualizar(nodo->dato, !insertado, extra);
+	return true;
+}
+
+void *hash_borrar_n(hash_t *hash, const void *clave, size_t largo){
+	return hash_borrar_con_hash(hash, clave, largo, funcion_hash(hash, clave, largo));
+}
+
+void *hash_borrar_con_hash(hash_t *hash, const void *clave, size_t largo, uint64_t h){
+	if (hash->mapa != NULL){
+		return NULL;
+	}
+	hash_migrar_paso(hash);
+	bool vencido = vencida(hash, clave, largo, h);
+	void* dato;
+	if (!par_borrar(hash, clave, largo, h, &dato)){
+		return NULL;
+	}
+	hash_achicar(hash);
+	// Un par vencido ya no estaba: su dato se destruye como al expirarlo.
+	if (vencido){
+		if (hash->destruir_dato){
+			hash->destruir_dato(dato);
+		}
+		return NULL;
+	}
+	return dato;
+}
+
+void *hash_obtener_n(const hash_t *hash, const void *clave, size_t largo){
+	return hash_obtener_con_hash(hash, clave, largo, funcion_hash(hash, clave, largo));
+}
+
+void *hash_obtener_con_hash(const hash_t *hash, const void *clave, size_t largo, uint64_t h){
+	if (hash->mapa != NULL){
+		size_t pos = mapa_buscar(hash, clave, largo, h);
+		return pos < hash->tabla.tam ? (void*) (uintptr_t) hash->mapa->ranuras[pos].dato : NULL;
+	}
+	// El hash se creó con malloc, así que avanzar la migración desde acá es válido.
+	hash_migrar_paso((hash_t*) hash);
+	if (filtro_descarta(hash, h)){
+		cache_buscado(hash, NULL);
+		return NULL;
+	}
+	nodo_t* nodo = buscar_nodo(hash, clave, largo, h);
+	if (nodo == NULL){
+		filtro_fallo(hash);
+	} else if (vencida(hash, clave, largo, h)){
+		nodo = NULL;
+	}
+	cache_buscado(hash, nodo);
+	return nodo ? nodo->dato : NULL;
+}
+
+bool hash_pertenece_n(const hash_t *hash, const void *clave, size_t largo){
+	return hash_pertenece_con_hash(hash, clave, largo, funcion_hash(hash, clave, largo));
+}
+
+bool hash_pertenece_con_hash(const hash_t *hash, const void *clave, size_t largo, uint64_t h){
+	if (hash->mapa != NULL){
+		return mapa_buscar(hash, clave, largo, h) < hash->tabla.tam;
+	}
+	if (filtro_descarta(hash, h)){
+		return false;
+	}
+	if (buscar_nodo(hash, clave, largo, h) == NULL){
+		filtro_fallo(hash);
+		return false;
+	}
+	return !vencida(hash, clave, largo, h);
+}
+
+bool hash_guardar_con_ttl(hash_t *hash, const char *clave, void *dato, uint64_t ttl){
+	return hash_guardar_con_ttl_n(hash, clave, strlen(clave), dato, ttl);
+}
+
+size_t hash_expirar(hash_t *hash, uint64_t ahora){
+	if (hash->vencimientos == NULL){
+		return 0;
+	}
+	size_t expirados = 0;
+	temporizador_t* temporizador;
+	while (expirados < HASH_EXPIRAR_LOTE
+			&& (temporizador = rueda_sacar_vencido(hash->vencimientos->rueda, ahora)) != NULL){
+		vigencia_t* vigencia = (vigencia_t*) temporizador;
+		// Ya no está en la rueda: se saca del índice antes de borrar el par,
+		// para que par_borrar no la busque.
+		vigencia_desindexar(hash, vigencia);
+		void* dato;
+		if (par_borrar(hash, vigencia->clave, vigencia->largo, vigencia->hash, &dato) && hash->destruir_dato){
+			hash->destruir_dato(dato);
+		}
+		free(vigencia);
+		expirados++;
+	}
+	if (expirados > 0){
+		hash_achicar(hash);
+	}
+	return expirados;
+}
+
+void hash_ttl_reloj(hash_t *hash, hash_reloj_t reloj){
+	hash->reloj = reloj ? reloj : hash_reloj_ms;
+}
+
+uint64_t hash_reloj_ms(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000 + (uint64_t) ts.tv_nsec / 1000000;
+}
+
+bool hash_guardar(hash_t *hash, const char *clave, void *dato){
+	return hash_guardar_n(hash, clave, strlen(clave), dato);
+}
+
+void *hash_borrar(hash_t *hash, const char *clave){
+	return hash_borrar_n(hash, clave, strlen(clave));
+}
+
+void *hash_obtener(const hash_t *hash, const char *clave){
+	return hash_obtener_n(hash, clave, strlen(clave));
+}
+
+bool hash_pertenece(const hash_t *hash, const char *clave){
+	return hash_pertenece_n(hash, clave, strlen(clave));
+}
+
+void hash_obtener_lote(const hash_t *hash, const char *const claves[], size_t n, void *resultados[]){
+	if (hash->mapa != NULL){
+		for (size_t i = 0; i < n; i++){
+			resultados[i] = hash_obtener(hash, claves[i]);
+		}
+		return;
+	}
+	size_t largos[TAM_LOTE];
+	uint64_t hashes[TAM_LOTE];
+	for (size_t inicio = 0; inicio < n; inicio += TAM_LOTE){
+		size_t cant = n - inicio < TAM_LOTE ? n - inicio : TAM_LOTE;
+		lote_preparar(hash, claves + inicio, cant, largos, hashes);
+		for (size_t i = 0; i < cant; i++){
+			// Igual que en hash_obtener, avanzar la migración desde acá es válido.
+			hash_migrar_paso((hash_t*) hash);
+			nodo_t* nodo = buscar_nodo(hash, claves[inicio + i], largos[i], hashes[i]);
+			if (nodo != NULL && vencida(hash, claves[inicio + i], largos[i], hashes[i])){
+				nodo = NULL;
+			}
+			cache_buscado(hash, nodo);
+			resultados[inicio + i] = nodo ? nodo->dato : NULL;
+		}
+	}
+}
+
+bool hash_guardar_lote(hash_t *hash, const char *const claves[], void *const datos[], size_t n){
+	if (hash->mapa != NULL){
+		return false;
+	}
+	size_t largos[TAM_LOTE];
+	uint64_t hashes[TAM_LOTE];
+	for (size_t inicio = 0; inicio < n; inicio += TAM_LOTE){
+		size_t cant = n - inicio < TAM_LOTE ? n - inicio : TAM_LOTE;
+		lote_preparar(hash, claves + inicio, cant, largos, hashes);
+		for (size_t i = 0; i < cant; i++){
+			if (!guardar(hash, claves[inicio + i], largos[i], hashes[i], datos[inicio + i])){
+				return false;
+			}
+			vencimiento_descartar(hash, claves[inicio + i], largos[i], hashes[i]);
+		}
+	}
+	return true;
+}
+
+hash_t *hash_construir(hash_destruir_dato_t destruir_dato, hash_tipo_t tipo, const char *const claves[],
+		void *const datos[], size_t n, size_t hilos){
+	hash_t* hash = hash_crear_con_tipo(destruir_dato, tipo);
+	if (hash == NULL){
+		return NULL;
+	}
+	// Tamaño final de una vez: el mismo al que llegaría guardando n claves.
+	size_t tam = tam_para(tipo, n);
+	tabla_t tabla;
+	if (tam != hash->tabla.tam){
+		if (!tabla_crear(&tabla, tipo, tam)){
+			hash_destruir(hash);
+			return NULL;
+		}
+		tabla_liberar(&hash->tabla);
+		hash->tabla = tabla;
+	}
+	if (n == 0){
+		return hash;
+	}
+
+	if (hilos == 0){
+		hilos = hilos_por_defecto();
+	}
+	if (hilos > n / CONSTRUIR_CLAVES_POR_HILO){
+		hilos = n / CONSTRUIR_CLAVES_POR_HILO > 0 ? n / CONSTRUIR_CLAVES_POR_HILO : 1;
+	}
+	construccion_t construccion = {.hash = hash, .claves = claves, .datos = datos, .n = n};
+	size_t* cuentas = NULL;
+	trabajador_t* trabajadores = NULL;
+	bool ok = construccion_crear(&construccion, hilos);
+	if (ok){
+		trabajadores = trabajadores_crear(&construccion, hilos, &cuentas);
+		ok = trabajadores != NULL;
+	}
+	if (ok){
+		ejecutar_en_paralelo(trabajadores, sizeof(trabajador_t), hilos, construir_hashear);
+		construir_acumular(&construccion, trabajadores);
+		ejecutar_en_paralelo(trabajadores, sizeof(trabajador_t), hilos, construir_repartir);
+		ejecutar_en_paralelo(trabajadores, sizeof(trabajador_t), hilos, construir_llenar);
+	}
+	if (trabajadores != NULL){
+		ok = construir_fusionar(hash, trabajadores, hilos) && ok;
+	}
+	ok = ok && (tipo == HASH_ABIERTO || construir_diferidas(&construccion));
+	free(trabajadores);
+	free(cuentas);
+	construccion_liberar(&construccion);
+	if (!ok){
+		// Los datos siguen siendo del que llamó.
+		hash->destruir_dato = NULL;
+		hash_destruir(hash);
+		return NULL;
+	}
+	return hash;
+}
+
+void **hash_obtener_o_insertar(hash_t *hash, const char *clave, bool *insertado){
+	return hash_obtener_o_insertar_n(hash, clave, strlen(clave), insertado);
+}
+
+bool hash_actualizar(hash_t *hash, const char *clave, hash_actualizar_dato_t actualizar, void *extra){
+	return hash_actualizar_n(hash, clave, strlen(clave), actualizar, extra);
+}
+
+void hash_iterar(const hash_t *hash, hash_visitar_t visitar, void *extra){
+	recorrido_t recorrido = {hash, 0, hash->vieja.tam + hash->tabla.tam, {visitar, extra, true, NULL}};
+	recorrido_visitar(&recorrido);
+}
+
+void hash_iterar_paralelo(const hash_t *hash, hash_visitar_t visitar, void *extra, size_t hilos){
+	size_t baldes = hash->vieja.tam + hash->tabla.tam;
+	if (hilos == 0){
+		hilos = hilos_por_defecto();
+	}
+	if (hilos > baldes){
+		hilos = baldes;
+	}
+	recorrido_t* recorridos = malloc(hilos * sizeof(recorrido_t));
+	if (recorridos == NULL){
+		hash_iterar(hash, visitar, extra);
+		return;
+	}
+	_Atomic bool cortar = false;
+	for (size_t i = 0; i < hilos; i++){
+		recorridos[i] = (recorrido_t) {hash, baldes * i / hilos, baldes * (i + 1) / hilos, {visitar, extra, true, &cortar}};
+	}
+	ejecutar_en_paralelo(recorridos, sizeof(recorrido_t), hilos, recorrido_visitar);
+	free(recorridos);
+}
+
+size_t hash_cantidad(const hash_t *hash){
+	return hash->tabla.cant + hash->vieja.cant;
+}
+
+bool hash_reservar(hash_t *hash, size_t cantidad){
+	if (hash->mapa != NULL){
+		return false;
+	}
+	size_t tam = tam_para(hash->tipo, cantidad);
+	if (tam > hash->tabla.tam && !hash_redimensionar(hash, tam)){
+		return false;
+	}
+	hash->tam_minimo = tam;
+	return true;
+}
+
+bool hash_compactar(hash_t *hash){
+	if (hash->mapa != NULL || (hash_migrando(hash) && !hash_migrar(hash, hash->vieja.tam))){
+		return false;
+	}
+	size_t tam = tam_para(hash->tipo, hash_cantidad(hash));
+	if (tam < hash->tam_minimo){
+		tam = hash->tam_minimo;
+	}
+	bool ok;
+	if (hash->tipo == HASH_ABIERTO){
+		ok = abierto_compactar(hash, tam);
+	} else{
+		// Rearmar la tabla, aunque sea del mismo tamaño, también limpia los borrados.
+		ok = (tam == hash->tabla.tam && hash->tabla.borrados == 0)
+			|| (hash_redimensionar(hash, tam) && hash_migrar(hash, hash->vieja.tam));
+	}
+	if (!ok){
+		return false;
+	}
+	if (arena_sin_uso(hash->claves) > 0){
+		hash_compactar_claves(hash);
+	}
+	if (hash->filtrado.filtro != NULL){
+		filtro_reconstruir(hash);
+	}
+	return true;
+}
+
+bool hash_filtro_activar(hash_t *hash, bool activar){
+	if (!activar){
+		if (hash->filtrado.filtro != NULL){
+			filtro_destruir(hash->filtrado.filtro);
+		}
+		hash->filtrado = (filtrado_t) {NULL, 0, 0, 0, 0};
+		return true;
+	}
+	if (hash->mapa != NULL){
+		return false;
+	}
+	if (hash->filtrado.filtro != NULL){
+		return true;
+	}
+	return filtro_reconstruir(hash);
+}
+
+void hash_destruir(hash_t *hash){
+	if (hash->filtrado.filtro != NULL){
+		filtro_destruir(hash->filtrado.filtro);
+	}
+	if (hash->vencimientos != NULL){
+		vencimientos_destruir(hash->vencimientos);
+	}
+	if (hash->mapa != NULL){
+		munmap(hash->mapa->base, hash->mapa->largo);
+		free(hash->mapa);
+		free(hash);
+		return;
+	}
+	tabla_destruir(hash, &hash->vieja);
+	tabla_destruir(hash, &hash->tabla);
+	hash_pools_destruir(hash);
+	arena_destruir(hash->claves);
+	free(hash);
+}
+
+void hash_estadisticas(const hash_t *hash, hash_estadisticas_t *estadisticas){
+	memset(estadisticas, 0, sizeof(hash_estadisticas_t));
+	estadisticas->tipo = hash->tipo;
+	estadisticas->cantidad = hash_cantidad(hash);
+	estadisticas->capacidad = hash->tabla.tam;
+	estadisticas->factor_de_carga = (double) estadisticas->cantidad / (double) hash->tabla.tam;
+	estadisticas->borrados = hash->tabla.borrados + hash->vieja.borrados;
+	estadisticas->redimensiones = hash->redimensiones;
+	estadisticas->migrando = hash_migrando(hash);
+	const filtrado_t* filtrado = &hash->filtrado;
+	if (filtrado->filtro != NULL){
+		estadisticas->bytes_filtro = filtro_memoria(filtrado->filtro);
+		estadisticas->filtro_consultas = filtrado->consultas;
+		estadisticas->filtro_descartes = filtrado->descartes;
+		estadisticas->filtro_falsos_positivos = filtrado->falsos_positivos;
+		size_t ausentes = filtrado->descartes + filtrado->falsos_positivos;
+		if (ausentes > 0){
+			estadisticas->filtro_tasa_medida = (double) filtrado->falsos_positivos / (double) ausentes;
+		}
+		estadisticas->filtro_tasa_estimada = filtro_tasa_estimada(filtrado->filtro);
+	}
+	estadisticas->cache_capacidad = hash->cache.capacidad;
+	estadisticas->cache_aciertos = hash->cache.aciertos;
+	estadisticas->cache_fallos = hash->cache.fallos;
+	estadisticas->cache_desalojos = hash->cache.desalojos;
+	estadisticas->con_vencimiento = hash->vencimientos ? rueda_cantidad(hash->vencimientos->rueda) : 0;
+
+	size_t suma = tabla_estadisticas(hash, &hash->tabla, estadisticas);
+	if (hash_migrando(hash)){
+		suma += tabla_estadisticas(hash, &hash->vieja, estadisticas);
+	}
+	if (estadisticas->cantidad > 0){
+		estadisticas->distancia_media = (double) suma / (double) estadisticas->cantidad;
+	}
+
+	if (hash->mapa != NULL){
+		estadisticas->bytes_tabla = hash->mapa->largo;
+		return;
+	}
+	estadisticas->bytes_tabla = tabla_bytes(hash->tipo, &hash->tabla) + tabla_bytes(hash->tipo, &hash->vieja);
+	if (hash->tipo == HASH_ABIERTO){
+		estadisticas->bytes_nodos = pool_memoria(hash->pares);
+		estadisticas->bytes_listas += pool_memoria(hash->eslabones);
+	}
+	estadisticas->bytes_claves = arena_memoria(hash->claves);
+	estadisticas->bytes_claves_sin_uso = arena_sin_uso(hash->claves);
+}
+
+bool hash_volcar(const hash_t *hash, const char *ruta){
+	volcado_t volcado = {NULL, NULL, 0, 0};
+	bool ok = volcado_armar(hash, &volcado);
+	// Se escribe en un archivo aparte y se renombra, para que quien abra la
+	// ruta vea la imagen anterior o la nueva completa.
+	size_t largo_ruta = strlen(ruta);
+	char* temporal = malloc(largo_ruta + sizeof(".tmp"));
+	FILE* archivo = NULL;
+	if (ok && temporal != NULL){
+		memcpy(temporal, ruta, largo_ruta);
+		memcpy(temporal + largo_ruta, ".tmp", sizeof(".tmp"));
+		archivo = fopen(temporal, "wb");
+	}
+	ok = ok && archivo != NULL && volcado_escribir(hash, &volcado, archivo);
+	if (archivo != NULL){
+		ok = fclose(archivo) == 0 && ok;
+		ok = ok && rename(temporal, ruta) == 0;
+		if (!ok){
+			remove(temporal);
+		}
+	}
+	free(temporal);
+	free(volcado.ctrl);
+	free(volcado.ranuras);
+	return ok;
+}
+
+hash_t *hash_abrir_mmap(const char *ruta){
+	int fd = open(ruta, O_RDONLY);
+	if (fd < 0){
+		return NULL;
+	}
+	struct stat estado;
+	void* base = MAP_FAILED;
+	if (fstat(fd, &estado) == 0 && (size_t) estado.st_size >= sizeof(imagen_cabecera_t)){
+		base = mmap(NULL, (size_t) estado.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	}
+	// El mapeo sigue siendo válido después de cerrar el archivo.
+	close(fd);
+	if (base == MAP_FAILED){
+		return NULL;
+	}
+	size_t largo = (size_t) estado.st_size;
+	const imagen_cabecera_t* cabecera = base;
+	hash_t* hash = malloc(sizeof(hash_t));
+	mapa_t* mapa = malloc(sizeof(mapa_t));
+	if (!imagen_es_valida(cabecera, largo) || hash == NULL || mapa == NULL){
+		munmap(base, largo);
+		free(hash);
+		free(mapa);
+		return NULL;
+	}
+	mapa->base = base;
+	mapa->largo = largo;
+	mapa->ranuras = (const ranura_t*) ((const char*) base + cabecera->ranuras);
+	mapa->claves = (const char*) base + cabecera->claves;
+
+	// Un hash cerrado cuyos bytes de control son los de la imagen; las
+	// búsquedas y el iterador van a las ranuras a través de mapa.
+	hash->tipo = HASH_CERRADO;
+	hash->tabla.listas = NULL;
+	hash->tabla.nodos = NULL;
+	hash->tabla.ctrl = (uint8_t*) base + cabecera->ctrl;
+	hash->tabla.ocupados = NULL;
+	hash->tabla.referencias = NULL;
+	hash->tabla.tam = cabecera->tam;
+	hash->tabla.cant = cabecera->cantidad;
+	hash->tabla.borrados = 0;
+	hash->vieja = (tabla_t) {NULL, NULL, NULL, NULL, NULL, 0, 0, 0};
+	hash->migrado = 0;
+	hash->incremental = false;
+	hash->iteradores = 0;
+	grupo_elegir(hash);
+	hash->claves = NULL;
+	hash->funcion = hash_funcion_wyhash;
+	hash->semilla = cabecera->semilla;
+	hash->pares = NULL;
+	hash->eslabones = NULL;
+	hash->mapa = mapa;
+	hash->redimensiones = 0;
+	hash->tam_minimo = TAM_INICIAL;
+	hash->filtrado = (filtrado_t) {NULL, 0, 0, 0, 0};
+	hash->cache = (cache_t) {0, 0, 0, 0, 0};
+	hash->vencimientos = NULL;
+	hash->reloj = hash_reloj_ms;
+	hash->destruir_dato = NULL;
+	return hash;
+}
 
 /* Iterador del hash */
 
-// Crea iterador
-hash_iter_t *hash_iter_crear(const hash_t *hash);
+hash_iter_t *hash_iter_crear(const hash_t *hash){
+	hash_iter_t* iter = malloc(sizeof(hash_iter_t));
+	if (iter == NULL){
+		return NULL;
+	}
+	hash_iter_iniciar(iter, hash);
+	return iter;
+}
 
-// Avanza iterador
-bool hash_iter_avanzar(hash_iter_t *iter);
+void hash_iter_iniciar(hash_iter_t *iter, const hash_t *hash){
+	iter->hash = hash;
+	iter->tabla = hash_migrando(hash) ? &hash->vieja : &hash->tabla;
+	iter->indice = 0;
+	iter->posicion = NULL;
+	iter_buscar_siguiente(iter);
+	((hash_t*) hash)->iteradores++;
+}
 
-// Devuelve clave actual, esa clave no se puede modificar ni liberar.
-const char *hash_iter_ver_actual(const hash_iter_t *iter);
+bool hash_iter_avanzar(hash_iter_t *iter){
+	if (hash_iter_al_final(iter)){
+		return false;
+	}
+	if (iter->hash->tipo == HASH_ABIERTO){
+		iter->posicion = lista_pos_siguiente(iter->posicion);
+		if (iter->posicion != NULL){
+			return true;
+		}
+	}
+	iter->indice++;
+	iter_buscar_siguiente(iter);
+	return true;
+}
 
-// Comprueba si terminó la iteración
-bool hash_iter_al_final(const hash_iter_t *iter);
+// Pre: El hash no es una imagen.
+static const nodo_t* iter_nodo_actual(const hash_iter_t* iter){
+	if (iter->hash->tipo == HASH_CERRADO){
+		const tabla_t* tabla = iter->tabla;
+		return &tabla->nodos[iter->indice];
+	}
+	return lista_pos_ver(iter->posicion);
+}
 
-// Destruye iterador
-void hash_iter_destruir(hash_iter_t *iter);
\ No newline at end of file
+// Pre: El hash es una imagen.
+static const ranura_t* iter_ranura_actual(const hash_iter_t* iter){
+	return &iter->hash->mapa->ranuras[iter->indice];
+}
+
+const char *hash_iter_ver_actual(const hash_iter_t *iter){
+	if (hash_iter_al_final(iter)){
+		return NULL;
+	}
+	if (iter->hash->mapa != NULL){
+		return iter->hash->mapa->claves + iter_ranura_actual(iter)->clave;
+	}
+	return nodo_clave(iter_nodo_actual(iter));
+}
+
+size_t hash_iter_ver_largo(const hash_iter_t *iter){
+	if (hash_iter_al_final(iter)){
+		return 0;
+	}
+	if (iter->hash->mapa != NULL){
+		return iter_ranura_actual(iter)->largo;
+	}
+	return iter_nodo_actual(iter)->largo;
+}
+
+void *hash_iter_ver_dato(const hash_iter_t *iter){
+	if (hash_iter_al_final(iter)){
+		return NULL;
+	}
+	if (iter->hash->mapa != NULL){
+		return (void*) (uintptr_t) iter_ranura_actual(iter)->dato;
+	}
+	return iter_nodo_actual(iter)->dato;
+}
+
+bool hash_iter_al_final(const hash_iter_t *iter){
+	const tabla_t* tabla = iter->tabla;
+	return tabla == &iter->hash->tabla && iter->indice >= tabla->tam;
+}
+
+void hash_iter_finalizar(hash_iter_t *iter){
+	((hash_t*) iter->hash)->iteradores--;
+}
+
+void hash_iter_destruir(hash_iter_t *iter){
+	hash_iter_finalizar(iter);
+	free(iter);
+}
@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 // Los structs deben llamarse "hash" y "hash_iter".
 struct hash;
@@ -14,10 +15,95 @@ typedef struct hash_iter hash_iter_t;
 // tipo de función para destruir dato
 typedef void (*hash_destruir_dato_t)(void *);
 
+// Implementación interna de la tabla.
+// HASH_ABIERTO: un arreglo de listas enlazadas (una por balde).
+// HASH_CERRADO: direccionamiento abierto con sondeo lineal sobre un único
+// arreglo contiguo de entradas.
+typedef enum hash_tipo {
+    HASH_ABIERTO,
+    HASH_CERRADO
+} hash_tipo_t;
+
+/* Función de hashing: para los mismos largo bytes de clave y la misma
+ * semilla tiene que devolver siempre el mismo valor. La tabla usa tanto los
+ * bits bajos como los altos del resultado.
+ */
+typedef uint64_t (*hash_funcion_t)(const void *clave, size_t largo, uint64_t semilla);
+
+/* Funciones de hashing incluidas. hash_funcion_wyhash procesa la clave de a
+ * 8 bytes y es la que se usa por defecto. hash_funcion_djb2 procesa un byte
+ * por vez y queda para comparar: aun con semilla, dos claves del mismo largo
+ * que colisionan lo hacen para cualquier semilla.
+ */
+uint64_t hash_funcion_wyhash(const void *clave, size_t largo, uint64_t semilla);
+uint64_t hash_funcion_djb2(const void *clave, size_t largo, uint64_t semilla);
+
 /* Crea el hash
  */
 hash_t *hash_crear(hash_destruir_dato_t destruir_dato);
 
+/* Crea el hash usando la implementación indicada. hash_crear equivale a
+ * hash_crear_con_tipo(destruir_dato, HASH_ABIERTO).
+ */
+hash_t *hash_crear_con_tipo(hash_destruir_dato_t destruir_dato, hash_tipo_t tipo);
+
+/* Crea el hash usando la implementación y la función de hashing indicadas
+ * (NULL para la de defecto). Cada hash elige una semilla aleatoria al
+ * crearse y se la pasa a la función en cada llamada.
+ */
+hash_t *hash_crear_con_funcion(hash_destruir_dato_t destruir_dato, hash_tipo_t tipo, hash_funcion_t funcion);
+
+/* Igual que hash_crear_con_funcion, pero con la semilla indicada en vez de
+ * una aleatoria, para que varios hashes calculen lo mismo para cada clave
+ * (ver hash_calcular). Si las claves vienen de afuera, la semilla tiene que
+ * ser aleatoria igual.
+ */
+hash_t *hash_crear_con_semilla(hash_destruir_dato_t destruir_dato, hash_tipo_t tipo, hash_funcion_t funcion, uint64_t semilla);
+
+/* Crea un hash cerrado que guarda hasta capacidad pares (mayor que 0). Al
+ * guardar una clave nueva con el cache lleno, desaloja un par con el
+ * algoritmo CLOCK y le aplica destruir_dato: cada posición tiene una marca
+ * que hash_obtener y hash_guardar prenden al encontrar la clave, y una mano
+ * que recorre la tabla en círculo apaga las marcas y desaloja el primer par
+ * que encuentra sin marcar (si se la apagó, desde hace por lo menos
+ * capacidad desalojos). Así, una búsqueda que acierta sólo escribe un byte,
+ * sin mover nodos ni tocar listas, y los pares guardados y nunca buscados
+ * salen antes que los buscados. hash_estadisticas informa aciertos, fallos
+ * y desalojos.
+ */
+hash_t *hash_crear_cache(size_t capacidad, hash_destruir_dato_t destruir_dato);
+
+/* Activa o desactiva la redimensión incremental. Activada, al agrandarse la
+ * tabla se conservan la tabla vieja y la nueva, y cada hash_guardar,
+ * hash_borrar y hash_obtener migra una cantidad acotada de baldes, en lugar
+ * de mover todos los elementos en una misma llamada. Mientras haya
+ * iteradores creados no se migra. Al desactivarla se termina la migración
+ * pendiente; devuelve false si no pudo hacerlo. Un cache (ver
+ * hash_crear_cache) no la admite: activarla devuelve false.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_redimension_incremental(hash_t *hash, bool activar);
+
+/* Agranda la tabla para que entren cantidad elementos sin redimensionarla
+ * mientras se guardan. Al borrar, la tabla se achica sola cuando queda
+ * ocupada menos de un cuarto de lo que admite, pero nunca por debajo de lo
+ * reservado; hash_reservar(hash, 0) quita la reserva. Devuelve false si no
+ * hay memoria o si el hash es una imagen de hash_abrir_mmap.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_reservar(hash_t *hash, size_t cantidad);
+
+/* Rearma el hash con la menor memoria posible para lo que tiene (o para lo
+ * reservado con hash_reservar, si es más): termina la redimensión en curso,
+ * achica la tabla, limpia las posiciones borradas del hash cerrado y
+ * devuelve al sistema la memoria de pares y claves borrados. Recorre todo el
+ * hash, así que conviene llamarla en momentos sin carga, por ejemplo después
+ * de borrar gran parte de los elementos. Devuelve false si no hay memoria;
+ * en ese caso el hash sigue siendo válido, con los mismos elementos.
+ * Pre: La estructura hash fue inicializada y no tiene iteradores creados
+ */
+bool hash_compactar(hash_t *hash);
+
 /* Guarda un elemento en el hash, si la clave ya se encuentra en la
  * estructura, la reemplaza. De no poder guardarlo devuelve false.
  * Pre: La estructura hash fue inicializada
@@ -44,6 +130,144 @@ void *hash_obtener(const hash_t *hash, const char *clave);
  */
 bool hash_pertenece(const hash_t *hash, const char *clave);
 
+/* Variantes de las primitivas anteriores para claves de largo explícito: la
+ * clave son los largo bytes a partir de clave, que pueden incluir '\0', y no
+ * hace falta que terminen en '\0'. Las versiones con strings equivalen a
+ * llamar a estas con largo = strlen(clave).
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_guardar_n(hash_t *hash, const void *clave, size_t largo, void *dato);
+void *hash_borrar_n(hash_t *hash, const void *clave, size_t largo);
+void *hash_obtener_n(const hash_t *hash, const void *clave, size_t largo);
+bool hash_pertenece_n(const hash_t *hash, const void *clave, size_t largo);
+
+/* hash_calcular devuelve lo que calcula la función de hashing del hash para
+ * la clave. Las variantes _con_hash reciben ese valor en h en vez de volver
+ * a calcularlo, para quien ya lo necesitó antes, por ejemplo para elegir
+ * entre varios hashes creados con la misma semilla.
+ * Pre: La estructura hash fue inicializada y h es
+ * hash_calcular(hash, clave, largo)
+ */
+uint64_t hash_calcular(const hash_t *hash, const void *clave, size_t largo);
+bool hash_guardar_con_hash(hash_t *hash, const void *clave, size_t largo, uint64_t h, void *dato);
+void *hash_borrar_con_hash(hash_t *hash, const void *clave, size_t largo, uint64_t h);
+void *hash_obtener_con_hash(const hash_t *hash, const void *clave, size_t largo, uint64_t h);
+bool hash_pertenece_con_hash(const hash_t *hash, const void *clave, size_t largo, uint64_t h);
+
+/* Equivale a resultados[i] = hash_obtener(hash, claves[i]) para cada i < n,
+ * pero busca varias claves a la vez para superponer los accesos a memoria.
+ * Conviene con tablas más grandes que la caché.
+ * Pre: La estructura hash fue inicializada, y claves y resultados tienen n
+ * elementos
+ */
+void hash_obtener_lote(const hash_t *hash, const char *const claves[], size_t n, void *resultados[]);
+
+/* Equivale a hash_guardar(hash, claves[i], datos[i]) para cada i < n, en
+ * orden, buscando varias claves a la vez. Si una clave se repite, queda el
+ * último dato. Devuelve false si no pudo guardar alguno de los pares; los
+ * anteriores a ese quedan guardados.
+ * Pre: La estructura hash fue inicializada, y claves y datos tienen n
+ * elementos
+ */
+bool hash_guardar_lote(hash_t *hash, const char *const claves[], void *const datos[], size_t n);
+
+/* Reloj de los vencimientos: devuelve el tiempo actual en la unidad en que
+ * se expresan los ttl, y nunca retrocede.
+ */
+typedef uint64_t (*hash_reloj_t)(void);
+
+/* Milisegundos de CLOCK_MONOTONIC: el reloj por defecto. */
+uint64_t hash_reloj_ms(void);
+
+/* Pares que hash_expirar procesa como máximo por llamada. */
+#define HASH_EXPIRAR_LOTE 1024
+
+/* Guarda un elemento como hash_guardar, que vence ttl unidades del reloj del
+ * hash después de ahora (milisegundos, salvo que se cambie con
+ * hash_ttl_reloj). Guardar de nuevo la clave con hash_guardar_con_ttl le
+ * pone el nuevo vencimiento; con hash_guardar, o con hash_guardar_lote, deja
+ * de vencer. Desde que vence, hash_obtener, hash_pertenece, hash_obtener_lote
+ * y hash_borrar lo tratan como ausente, aunque siga ocupando lugar (y
+ * contando en hash_cantidad, los iteradores y hash_volcar) hasta que
+ * hash_expirar lo saque o se guarde la clave de nuevo. De no poder guardarlo
+ * devuelve false.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_guardar_con_ttl(hash_t *hash, const char *clave, void *dato, uint64_t ttl);
+bool hash_guardar_con_ttl_n(hash_t *hash, const void *clave, size_t largo, void *dato, uint64_t ttl);
+
+/* Saca los pares vencidos hasta ahora (en la unidad del reloj del hash) y
+ * les aplica destruir_dato. Los vencimientos están en una rueda de
+ * temporizadores jerárquica (ver rueda.h), así que el costo es proporcional
+ * a los pares vencidos y no al tamaño del hash. Procesa hasta
+ * HASH_EXPIRAR_LOTE pares por llamada, para acotar la pausa, y devuelve
+ * cuántos sacó: si son HASH_EXPIRAR_LOTE puede haber más.
+ * Pre: La estructura hash fue inicializada
+ */
+size_t hash_expirar(hash_t *hash, uint64_t ahora);
+
+/* Cambia el reloj de los vencimientos (NULL para hash_reloj_ms). Conviene
+ * hacerlo antes de guardar el primer par con vencimiento.
+ * Pre: La estructura hash fue inicializada
+ */
+void hash_ttl_reloj(hash_t *hash, hash_reloj_t reloj);
+
+/* Crea un hash con los pares (claves[i], datos[i]) para cada i < n, usando
+ * hasta hilos hilos (0 para uno por procesador). Dimensiona la tabla una
+ * sola vez para n claves, calcula los hashes en paralelo, reparte las claves
+ * por rangos de baldes y cada hilo llena los suyos. Si una clave se repite,
+ * queda el último dato y los anteriores se pasan a destruir_dato (desde
+ * cualquiera de los hilos), igual que con hash_guardar. El resultado es un
+ * hash común. Devuelve NULL si falta memoria; en ese caso los datos que no
+ * fueron reemplazados por una clave repetida no se destruyen.
+ * Pre: claves y datos tienen n elementos
+ */
+hash_t *hash_construir(hash_destruir_dato_t destruir_dato, hash_tipo_t tipo, const char *const claves[],
+                       void *const datos[], size_t n, size_t hilos);
+
+/* Devuelve la dirección del dato asociado a la clave. Si la clave no estaba,
+ * antes la guarda con dato NULL. En insertado (si no es NULL) se indica cuál
+ * de los dos casos ocurrió. Devuelve NULL si no pudo guardarla. La dirección
+ * sólo es válida hasta la próxima operación que modifique el hash.
+ * Pre: La estructura hash fue inicializada
+ */
+void **hash_obtener_o_insertar(hash_t *hash, const char *clave, bool *insertado);
+void **hash_obtener_o_insertar_n(hash_t *hash, const void *clave, size_t largo, bool *insertado);
+
+/* Recibe el dato actual de la clave (NULL si no estaba, en cuyo caso
+ * existia es false) y devuelve el nuevo.
+ */
+typedef void *(*hash_actualizar_dato_t)(void *dato, bool existia, void *extra);
+
+/* Reemplaza el dato de la clave por actualizar(dato, existia, extra),
+ * guardando la clave si no estaba. No se llama a destruir_dato con el dato
+ * anterior: si hay que liberarlo, lo hace actualizar. Devuelve false si no
+ * pudo guardar la clave.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_actualizar(hash_t *hash, const char *clave, hash_actualizar_dato_t actualizar, void *extra);
+bool hash_actualizar_n(hash_t *hash, const void *clave, size_t largo, hash_actualizar_dato_t actualizar, void *extra);
+
+/* Recibe cada par del hash; devuelve false para cortar el recorrido.
+ */
+typedef bool (*hash_visitar_t)(const char *clave, void *dato, void *extra);
+
+/* Llama a visitar(clave, dato, extra) para cada par, en el orden del
+ * iterador, hasta que visitar devuelva false. A diferencia del iterador no
+ * pide memoria, y da el dato junto con la clave.
+ * Pre: La estructura hash fue inicializada, y visitar no la modifica
+ */
+void hash_iterar(const hash_t *hash, hash_visitar_t visitar, void *extra);
+
+/* Como hash_iterar, pero reparte los baldes en rangos contiguos entre hasta
+ * hilos hilos (0 para uno por procesador), así que visitar se llama desde
+ * varios hilos a la vez y sin un orden definido. Si devuelve false, todos
+ * los hilos dejan de visitar pares lo antes posible.
+ * Pre: La estructura hash fue inicializada, nadie la modifica durante el
+ * recorrido, y visitar se puede llamar desde varios hilos a la vez
+ */
+void hash_iterar_paralelo(const hash_t *hash, hash_visitar_t visitar, void *extra, size_t hilos);
+
 /* Devuelve la cantidad de elementos del hash.
  * Pre: La estructura hash fue inicializada
  */
@@ -56,17 +280,132 @@ size_t hash_cantidad(const hash_t *hash);
  */
 void hash_destruir(hash_t *hash);
 
+/* Largos distintos que distingue el histograma de hash_estadisticas; el
+ * último cuenta también todos los mayores.
+ */
+#define HASH_ESTADISTICAS_LARGOS 16
+
+typedef struct hash_estadisticas {
+    hash_tipo_t tipo;
+    size_t cantidad;
+    size_t capacidad;           /* Baldes o posiciones de la tabla actual. */
+    double factor_de_carga;     /* cantidad / capacidad. */
+    size_t borrados;            /* HASH_CERRADO: posiciones marcadas como borradas. */
+    size_t redimensiones;       /* Veces que se reemplazó la tabla. */
+    bool migrando;              /* Hay una redimensión incremental en curso. */
+    /* HASH_ABIERTO: cantidad de baldes con i pares.
+     * HASH_CERRADO: cantidad de pares a distancia i de su posición inicial. */
+    size_t histograma[HASH_ESTADISTICAS_LARGOS];
+    /* Distancia de cada par al comienzo de su búsqueda: la posición en la
+     * lista de su balde, o las posiciones que hay que avanzar desde la
+     * inicial. 0 si se lo encuentra en el primer intento. */
+    size_t distancia_maxima;
+    double distancia_media;
+    /* Memoria en bytes. Con una imagen de hash_abrir_mmap, bytes_tabla es el
+     * tamaño del mapeo y el resto queda en 0. */
+    size_t bytes_tabla;         /* Arreglos de baldes o posiciones. */
+    size_t bytes_nodos;         /* HASH_ABIERTO: nodos de los pares. */
+    size_t bytes_listas;        /* HASH_ABIERTO: listas de los baldes y sus nodos. */
+    size_t bytes_claves;        /* Copias de las claves que no entran en los nodos. */
+    size_t bytes_claves_sin_uso;   /* De bytes_claves, lo que ocupan claves ya borradas. */
+    /* Filtro de hash_filtro_activar; todo en 0 si no está activado. Los
+     * contadores son desde que se activó. */
+    size_t bytes_filtro;
+    size_t filtro_consultas;        /* Búsquedas de hash_obtener y hash_pertenece. */
+    size_t filtro_descartes;        /* Respondidas sólo con el filtro. */
+    size_t filtro_falsos_positivos; /* Pasaron el filtro y la clave no estaba. */
+    double filtro_tasa_medida;      /* Falsos positivos sobre búsquedas de claves ausentes. */
+    double filtro_tasa_estimada;    /* La esperada con lo que tiene el filtro ahora. */
+    /* Cache de hash_crear_cache; todo en 0 si no es un cache. */
+    size_t cache_capacidad;
+    size_t cache_aciertos;          /* Búsquedas de hash_obtener que encontraron la clave. */
+    size_t cache_fallos;
+    size_t cache_desalojos;
+    size_t con_vencimiento;         /* Pares guardados con hash_guardar_con_ttl y no expirados. */
+} hash_estadisticas_t;
+
+/* Activa o desactiva un filtro de Bloom con las claves guardadas, que
+ * hash_obtener y hash_pertenece consultan antes de buscar: para casi todas
+ * las claves ausentes la búsqueda termina en una línea de caché del filtro,
+ * sin recorrer la tabla ni comparar claves. Conviene con HASH_ABIERTO cuando
+ * la mayoría de las búsquedas son de claves ausentes; en HASH_CERRADO esas
+ * búsquedas ya suelen terminar en el primer grupo de control. Ocupa entre
+ * 1,5 y 3 bytes por clave y deja pasar menos del 0,5% de las ausentes (ver
+ * hash_estadisticas). Se mantiene al guardar, y se vuelve a armar cuando las
+ * claves pasan el doble de las que había al armarlo o cuando las borradas
+ * superan a las vigentes. hash_obtener_lote no lo usa. Devuelve false si no
+ * hay memoria o si el hash es una imagen de hash_abrir_mmap.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_filtro_activar(hash_t *hash, bool activar);
+
+/* Completa estadisticas con el estado actual del hash. Recorre toda la
+ * tabla, así que es O(capacidad): pensada para diagnóstico y métricas
+ * periódicas, no para cada operación. Si hay una redimensión incremental en
+ * curso, los histogramas y distancias incluyen los pares de las dos tablas.
+ * Pre: La estructura hash fue inicializada
+ */
+void hash_estadisticas(const hash_t *hash, hash_estadisticas_t *estadisticas);
+
+/* Escribe en ruta una imagen del hash que se puede abrir con
+ * hash_abrir_mmap: una cabecera, un arreglo de posiciones como el del hash
+ * cerrado y las claves seguidas, todo con desplazamientos en lugar de
+ * punteros. Los datos se guardan como el valor de sus punteros, así que
+ * sólo sirven si son valores codificados en el puntero (enteros, índices,
+ * desplazamientos) y no direcciones de memoria. La imagen se escribe en
+ * ruta + ".tmp" y se renombra al terminar. Devuelve false si no pudo.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_volcar(const hash_t *hash, const char *ruta);
+
+/* Abre una imagen escrita por hash_volcar mapeándola en memoria de sólo
+ * lectura, sin copiar ni recorrer las claves: cada página se lee recién
+ * cuando se usa, y varios procesos que abran la misma imagen comparten la
+ * caché de páginas. Sobre el resultado funcionan hash_obtener,
+ * hash_pertenece, hash_cantidad, los iteradores, hash_iterar y hash_volcar;
+ * las primitivas que modifican el hash no hacen nada y devuelven false o
+ * NULL. hash_destruir libera el mapeo sin llamar a ninguna función sobre los
+ * datos. Devuelve NULL si no pudo abrir la imagen o no es válida.
+ * Pre: La imagen no se modifica mientras esté abierta
+ */
+hash_t *hash_abrir_mmap(const char *ruta);
+
 /* Iterador del hash */
 
+// Se define acá sólo para poder declarar iteradores en la pila con
+// hash_iter_iniciar; sus campos son privados.
+struct hash_iter {
+    const hash_t *hash;
+    const void *tabla;      // Tabla que se recorre.
+    size_t indice;          // Balde o posición actual en esa tabla.
+    const void *posicion;   // Hash abierto: posición en la lista del balde.
+};
+
 // Crea iterador
 hash_iter_t *hash_iter_crear(const hash_t *hash);
 
+// Inicializa un iterador que ya tiene memoria, por ejemplo declarado en la
+// pila, sin pedir memoria. Mientras el iterador no se finalice, el hash no
+// avanza su redimensión incremental.
+void hash_iter_iniciar(hash_iter_t *iter, const hash_t *hash);
+
+// Finaliza un iterador inicializado con hash_iter_iniciar.
+void hash_iter_finalizar(hash_iter_t *iter);
+
 // Avanza iterador
 bool hash_iter_avanzar(hash_iter_t *iter);
 
 // Devuelve clave actual, esa clave no se puede modificar ni liberar.
+// La copia de la clave siempre termina con un '\0' agregado, y sigue siendo
+// válida mientras no se modifique el hash.
 const char *hash_iter_ver_actual(const hash_iter_t *iter);
 
+// Devuelve el largo de la clave actual, sin contar el '\0' agregado.
+size_t hash_iter_ver_largo(const hash_iter_t *iter);
+
+// Devuelve el dato de la clave actual, o NULL si terminó la iteración.
+void *hash_iter_ver_dato(const hash_iter_t *iter);
+
 // Comprueba si terminó la iteración
 bool hash_iter_al_final(const hash_iter_t *iter);
 
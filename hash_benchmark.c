@@ -0,0 +1,1373 @@
+/*
+ * hash_benchmark.c
+ * Mediciones de rendimiento del hash. No forma parte de las pruebas; se
+ * compila aparte y con optimizaciones, por ejemplo:
+ *
+ *     gcc -O2 -std=gnu11 hash_benchmark.c hash.c hash_concurrente.c hash_u64.c epoca.c lista.c \
+ *         arena.c pool.c filtro.c rueda.c -o hash_benchmark -lpthread -lm
+ *
+ * Para contar las llamadas al allocator en "rotacion", agregar
+ *
+ *     -DCONTAR_MALLOC -Wl,--wrap=malloc,--wrap=calloc,--wrap=free
+ *
+ * Uso: ./hash_benchmark latencia|rotacion|funciones|conteo|lote|hilos|construir|recorrer|volcado|enteros|filtro|cache|ttl [cantidad]
+ *      ./hash_benchmark suite [cantidad,cantidad,...] [texto|csv|json]
+ *
+ * "suite" mide todas las operaciones básicas con varias distribuciones de
+ * claves y tamaños, y está pensada para guardar su salida y comparar entre
+ * versiones (ver la sección SUITE COMPLETA).
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "hash.h"
+#include "hash_concurrente.h"
+#include "hash_tipado.h"
+#include "hash_u64.h"
+
+#include <inttypes.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#define LARGO_CLAVE 24
+
+#ifdef CONTAR_MALLOC
+void *__real_malloc(size_t tam);
+void *__real_calloc(size_t cantidad, size_t tam);
+void __real_free(void *ptr);
+
+static size_t pedidos = 0;
+static size_t liberados = 0;
+
+void *__wrap_malloc(size_t tam){
+	pedidos++;
+	return __real_malloc(tam);
+}
+
+void *__wrap_calloc(size_t cantidad, size_t tam){
+	pedidos++;
+	return __real_calloc(cantidad, tam);
+}
+
+void __wrap_free(void *ptr){
+	if (ptr != NULL){
+		liberados++;
+	}
+	__real_free(ptr);
+}
+#endif
+
+/* ******************************************************************
+ *                        AUXILIARES
+ * *****************************************************************/
+
+static uint64_t ahora_ns(void){
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint64_t) t.tv_sec * 1000000000ULL + (uint64_t) t.tv_nsec;
+}
+
+// Claves "%08zu" como las de prueba_hash_volumen.
+static char (*claves_secuenciales(size_t cantidad))[LARGO_CLAVE]{
+	char (*claves)[LARGO_CLAVE] = malloc(cantidad * LARGO_CLAVE);
+	if (claves == NULL){
+		return NULL;
+	}
+	for (size_t i = 0; i < cantidad; i++){
+		snprintf(claves[i], LARGO_CLAVE, "%08zu", i);
+	}
+	return claves;
+}
+
+static int comparar_u64(const void* a, const void* b){
+	uint64_t x = *(const uint64_t*) a;
+	uint64_t y = *(const uint64_t*) b;
+	return (x > y) - (x < y);
+}
+
+// Percentil p (0 a 100) de un arreglo ordenado.
+static uint64_t percentil(const uint64_t* ordenado, size_t cantidad, double p){
+	size_t i = (size_t) (p / 100.0 * (double) (cantidad - 1));
+	return ordenado[i];
+}
+
+/* ******************************************************************
+ *                        LATENCIA DE INSERCIÓN
+ * *****************************************************************/
+
+static void latencia_guardar(hash_tipo_t tipo, bool incremental, char (*claves)[LARGO_CLAVE], size_t cantidad, uint64_t* tiempos){
+	hash_t* hash = hash_crear_con_tipo(NULL, tipo);
+	hash_redimension_incremental(hash, incremental);
+	uint64_t inicio = ahora_ns();
+	for (size_t i = 0; i < cantidad; i++){
+		uint64_t t0 = ahora_ns();
+		hash_guardar(hash, claves[i], claves[i]);
+		tiempos[i] = ahora_ns() - t0;
+	}
+	uint64_t total = ahora_ns() - inicio;
+	hash_destruir(hash);
+
+	qsort(tiempos, cantidad, sizeof(uint64_t), comparar_u64);
+	printf("%-8s %-11s %10zu %8.1f %8" PRIu64 " %8" PRIu64 " %8" PRIu64 " %9" PRIu64 " %12" PRIu64 "\n",
+		tipo == HASH_CERRADO ? "cerrado" : "abierto", incremental ? "incremental" : "completa", cantidad,
+		(double) total / (double) cantidad, percentil(tiempos, cantidad, 50), percentil(tiempos, cantidad, 99),
+		percentil(tiempos, cantidad, 99.9), percentil(tiempos, cantidad, 99.99), tiempos[cantidad - 1]);
+}
+
+static void benchmark_latencia(size_t cantidad){
+	char (*claves)[LARGO_CLAVE] = claves_secuenciales(cantidad);
+	uint64_t* tiempos = malloc(cantidad * sizeof(uint64_t));
+	if (claves == NULL || tiempos == NULL){
+		fprintf(stderr, "sin memoria\n");
+		free(claves);
+		free(tiempos);
+		return;
+	}
+	printf("# latencia de hash_guardar en ns\n");
+	printf("%-8s %-11s %10s %8s %8s %8s %8s %9s %12s\n", "tipo", "redimension", "cantidad",
+		"media", "p50", "p99", "p99.9", "p99.99", "max");
+	for (int tipo = HASH_ABIERTO; tipo <= HASH_CERRADO; tipo++){
+		latencia_guardar((hash_tipo_t) tipo, false, claves, cantidad, tiempos);
+		latencia_guardar((hash_tipo_t) tipo, true, claves, cantidad, tiempos);
+	}
+	free(claves);
+	free(tiempos);
+}
+
+/* ******************************************************************
+ *                        ROTACIÓN DE CLAVES
+ * *****************************************************************/
+
+// Con el hash lleno con cantidad claves, cada paso guarda una clave nueva y
+// borra la más vieja, así que la cantidad de pares queda fija.
+static void rotacion(hash_tipo_t tipo, char (*claves)[LARGO_CLAVE], size_t cantidad){
+	hash_t* hash = hash_crear_con_tipo(NULL, tipo);
+	for (size_t i = 0; i < cantidad; i++){
+		hash_guardar(hash, claves[i], claves[i]);
+	}
+#ifdef CONTAR_MALLOC
+	size_t pedidos_antes = pedidos, liberados_antes = liberados;
+#endif
+	uint64_t inicio = ahora_ns();
+	for (size_t i = 0; i < cantidad; i++){
+		hash_guardar(hash, claves[cantidad + i], claves[cantidad + i]);
+		hash_borrar(hash, claves[i]);
+	}
+	uint64_t total = ahora_ns() - inicio;
+	printf("%-8s %10zu %10.1f", tipo == HASH_CERRADO ? "cerrado" : "abierto", cantidad,
+		(double) total / (double) cantidad);
+#ifdef CONTAR_MALLOC
+	printf(" %10.4f %10.4f", (double) (pedidos - pedidos_antes) / (double) cantidad,
+		(double) (liberados - liberados_antes) / (double) cantidad);
+#endif
+	printf("\n");
+	hash_destruir(hash);
+}
+
+static void benchmark_rotacion(size_t cantidad){
+	char (*claves)[LARGO_CLAVE] = claves_secuenciales(2 * cantidad);
+	if (claves == NULL){
+		fprintf(stderr, "sin memoria\n");
+		return;
+	}
+	printf("# guardar + borrar con cantidad fija de pares; ns por paso\n");
+	printf("%-8s %10s %10s", "tipo", "cantidad", "ns/paso");
+#ifdef CONTAR_MALLOC
+	printf(" %10s %10s", "malloc/p", "free/p");
+#endif
+	printf("\n");
+	for (int tipo = HASH_ABIERTO; tipo <= HASH_CERRADO; tipo++){
+		rotacion((hash_tipo_t) tipo, claves, cantidad);
+	}
+	free(claves);
+}
+
+/* ******************************************************************
+ *                        FUNCIONES DE HASHING
+ * *****************************************************************/
+
+// Evita que el compilador descarte los hashes calculados.
+static volatile uint64_t sumidero;
+
+static void rendimiento_funcion(const char* nombre, hash_funcion_t funcion, const unsigned char* datos,
+		size_t tam_datos, size_t largo, size_t cantidad){
+	uint64_t acumulado = 0;
+	size_t desplazamientos = tam_datos - largo + 1;
+	uint64_t inicio = ahora_ns();
+	for (size_t i = 0; i < cantidad; i++){
+		// Cada clave empieza en otro lugar, para que no quede siempre la misma en caché.
+		acumulado += funcion(datos + (i * 64) % desplazamientos, largo, i);
+	}
+	uint64_t total = ahora_ns() - inicio;
+	sumidero = acumulado;
+	printf("%-8s %8zu %10.2f %10.2f\n", nombre, largo, (double) total / (double) cantidad,
+		(double) (largo * cantidad) / (double) total);
+}
+
+static void benchmark_funciones(size_t cantidad){
+	static const size_t largos[] = {4, 8, 16, 24, 32, 64, 256, 1024, 4096};
+	const size_t tam_datos = 64 * 1024;
+	unsigned char* datos = malloc(tam_datos);
+	if (datos == NULL){
+		fprintf(stderr, "sin memoria\n");
+		return;
+	}
+	for (size_t i = 0; i < tam_datos; i++){
+		datos[i] = (unsigned char) (i * 131 + 7);
+	}
+	printf("# rendimiento de las funciones de hashing\n");
+	printf("%-8s %8s %10s %10s\n", "funcion", "largo", "ns/clave", "GB/s");
+	for (size_t i = 0; i < sizeof(largos) / sizeof(largos[0]); i++){
+		// Unos 4 GB procesados como máximo por medición.
+		size_t veces = cantidad;
+		if (veces * largos[i] > ((size_t) 4 << 30)){
+			veces = ((size_t) 4 << 30) / largos[i];
+		}
+		rendimiento_funcion("wyhash", hash_funcion_wyhash, datos, tam_datos, largos[i], veces);
+		rendimiento_funcion("djb2", hash_funcion_djb2, datos, tam_datos, largos[i], veces);
+	}
+	free(datos);
+}
+
+/* ******************************************************************
+ *                        CONTEO DE APARICIONES
+ * *****************************************************************/
+
+// Los contadores se guardan en el propio puntero del dato.
+static void* sumar_uno(void* dato, bool existia, void* extra){
+	(void) existia;
+	(void) extra;
+	return (void*) ((uintptr_t) dato + 1);
+}
+
+typedef enum conteo_modo{
+	CONTEO_PERTENECE,	// hash_pertenece + hash_obtener + hash_guardar.
+	CONTEO_SLOT,		// hash_obtener_o_insertar.
+	CONTEO_ACTUALIZAR,	// hash_actualizar.
+} conteo_modo_t;
+
+static void conteo(hash_tipo_t tipo, conteo_modo_t modo, char (*claves)[LARGO_CLAVE], size_t distintas, size_t cantidad){
+	static const char* nombres[] = {"pertenece+obtener+guardar", "obtener_o_insertar", "actualizar"};
+	hash_t* hash = hash_crear_con_tipo(NULL, tipo);
+	uint64_t inicio = ahora_ns();
+	for (size_t i = 0; i < cantidad; i++){
+		// Recorre las claves en un orden que no sigue al de inserción.
+		const char* clave = claves[(i * 2654435761u) % distintas];
+		if (modo == CONTEO_PERTENECE){
+			uintptr_t anterior = 0;
+			if (hash_pertenece(hash, clave)){
+				void* dato = hash_obtener(hash, clave);
+				anterior = (uintptr_t) dato;
+			}
+			hash_guardar(hash, clave, (void*) (anterior + 1));
+		} else if (modo == CONTEO_SLOT){
+			void** dato = hash_obtener_o_insertar(hash, clave, NULL);
+			*dato = (void*) ((uintptr_t) *dato + 1);
+		} else{
+			hash_actualizar(hash, clave, sumar_uno, NULL);
+		}
+	}
+	uint64_t total = ahora_ns() - inicio;
+	printf("%-8s %-26s %10zu %10zu %10.1f\n", tipo == HASH_CERRADO ? "cerrado" : "abierto", nombres[modo],
+		distintas, cantidad, (double) total / (double) cantidad);
+	hash_destruir(hash);
+}
+
+HASH_DEFINIR(conteo_tipado, const char*, size_t, hash_tipado_cadena, hash_tipado_igual_cadena)
+
+// El mismo conteo con un hash de HASH_DEFINIR: el contador se guarda en la
+// tabla y la clave es el puntero a la cadena, sin copia.
+static void conteo_con_tipado(char (*claves)[LARGO_CLAVE], size_t distintas, size_t cantidad){
+	conteo_tipado_t* hash = conteo_tipado_crear();
+	uint64_t inicio = ahora_ns();
+	for (size_t i = 0; i < cantidad; i++){
+		const char* clave = claves[(i * 2654435761u) % distintas];
+		(*conteo_tipado_obtener_o_insertar(hash, clave, NULL))++;
+	}
+	uint64_t total = ahora_ns() - inicio;
+	printf("%-8s %-26s %10zu %10zu %10.1f\n", "tipado", "obtener_o_insertar", distintas, cantidad,
+		(double) total / (double) cantidad);
+	conteo_tipado_destruir(hash);
+}
+
+static void benchmark_conteo(size_t cantidad){
+	size_t distintas = cantidad / 10 > 0 ? cantidad / 10 : 1;
+	char (*claves)[LARGO_CLAVE] = claves_secuenciales(distintas);
+	if (claves == NULL){
+		fprintf(stderr, "sin memoria\n");
+		return;
+	}
+	printf("# contar apariciones de claves; ns por aparición\n");
+	printf("%-8s %-26s %10s %10s %10s\n", "tipo", "modo", "distintas", "cantidad", "ns/op");
+	for (int tipo = HASH_ABIERTO; tipo <= HASH_CERRADO; tipo++){
+		for (int modo = CONTEO_PERTENECE; modo <= CONTEO_ACTUALIZAR; modo++){
+			conteo((hash_tipo_t) tipo, (conteo_modo_t) modo, claves, distintas, cantidad);
+		}
+	}
+	conteo_con_tipado(claves, distintas, cantidad);
+	free(claves);
+}
+
+/* ******************************************************************
+ *                        BÚSQUEDAS EN LOTE
+ * *****************************************************************/
+
+#define CLAVES_POR_LLAMADA 1024
+
+static void lote(hash_tipo_t tipo, char (*claves)[LARGO_CLAVE], const char** punteros, void** datos, size_t cantidad){
+	const char* nombre = tipo == HASH_CERRADO ? "cerrado" : "abierto";
+
+	hash_t* hash = hash_crear_con_tipo(NULL, tipo);
+	uint64_t inicio = ahora_ns();
+	for (size_t i = 0; i < cantidad; i++){
+		hash_guardar(hash, claves[i], claves[i]);
+	}
+	printf("%-8s %-28s %10.1f\n", nombre, "hash_guardar", (double) (ahora_ns() - inicio) / (double) cantidad);
+	hash_destruir(hash);
+
+	hash = hash_crear_con_tipo(NULL, tipo);
+	inicio = ahora_ns();
+	for (size_t i = 0; i < cantidad; i += CLAVES_POR_LLAMADA){
+		size_t n = cantidad - i < CLAVES_POR_LLAMADA ? cantidad - i : CLAVES_POR_LLAMADA;
+		hash_guardar_lote(hash, punteros + i, datos + i, n);
+	}
+	printf("%-8s %-28s %10.1f\n", nombre, "hash_guardar_lote", (double) (ahora_ns() - inicio) / (double) cantidad);
+
+	// El ciclo de verificación de prueba_hash_volumen.
+	size_t encontrados = 0;
+	inicio = ahora_ns();
+	for (size_t i = 0; i < cantidad; i++){
+		encontrados += hash_pertenece(hash, claves[i]) && hash_obtener(hash, claves[i]) == claves[i];
+	}
+	printf("%-8s %-28s %10.1f\n", nombre, "hash_pertenece+hash_obtener", (double) (ahora_ns() - inicio) / (double) cantidad);
+
+	inicio = ahora_ns();
+	for (size_t i = 0; i < cantidad; i++){
+		encontrados += hash_obtener(hash, claves[i]) == claves[i];
+	}
+	printf("%-8s %-28s %10.1f\n", nombre, "hash_obtener", (double) (ahora_ns() - inicio) / (double) cantidad);
+
+	void* resultados[CLAVES_POR_LLAMADA];
+	inicio = ahora_ns();
+	for (size_t i = 0; i < cantidad; i += CLAVES_POR_LLAMADA){
+		size_t n = cantidad - i < CLAVES_POR_LLAMADA ? cantidad - i : CLAVES_POR_LLAMADA;
+		hash_obtener_lote(hash, punteros + i, n, resultados);
+		for (size_t j = 0; j < n; j++){
+			encontrados += resultados[j] == claves[i + j];
+		}
+	}
+	printf("%-8s %-28s %10.1f\n", nombre, "hash_obtener_lote", (double) (ahora_ns() - inicio) / (double) cantidad);
+	if (encontrados != 3 * cantidad){
+		fprintf(stderr, "%s: faltan claves\n", nombre);
+	}
+	hash_destruir(hash);
+}
+
+static void benchmark_lote(size_t cantidad){
+	char (*claves)[LARGO_CLAVE] = claves_secuenciales(cantidad);
+	const char** punteros = malloc(cantidad * sizeof(char*));
+	void** datos = malloc(cantidad * sizeof(void*));
+	if (claves == NULL || punteros == NULL || datos == NULL){
+		fprintf(stderr, "sin memoria\n");
+		free(claves);
+		free(punteros);
+		free(datos);
+		return;
+	}
+	for (size_t i = 0; i < cantidad; i++){
+		punteros[i] = claves[i];
+		datos[i] = claves[i];
+	}
+	printf("# %zu claves, de a %d por llamada en los lotes; ns por clave\n", cantidad, CLAVES_POR_LLAMADA);
+	for (int tipo = HASH_ABIERTO; tipo <= HASH_CERRADO; tipo++){
+		lote((hash_tipo_t) tipo, claves, punteros, datos, cantidad);
+	}
+	free(claves);
+	free(punteros);
+	free(datos);
+}
+
+/* ******************************************************************
+ *                        ESCALABILIDAD CON HILOS
+ * *****************************************************************/
+
+#define MAX_HILOS 64
+
+typedef struct hilo_benchmark{
+	hash_concurrente_t* hash;
+	char (*claves)[LARGO_CLAVE];
+	size_t cantidad_claves;
+	size_t operaciones;
+	unsigned lecturas;	// Porcentaje de operaciones que son hash_concurrente_obtener.
+	uint64_t estado;	// Del generador xorshift.
+} hilo_benchmark_t;
+
+static uint64_t xorshift(uint64_t* estado){
+	uint64_t x = *estado;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	return *estado = x;
+}
+
+// Las escrituras guardan o borran una clave al azar, en partes iguales, así
+// la cantidad de pares se mantiene cerca de la inicial.
+static void* hilo_operar(void* extra){
+	hilo_benchmark_t* hilo = extra;
+	for (size_t i = 0; i < hilo->operaciones; i++){
+		uint64_t r = xorshift(&hilo->estado);
+		const char* clave = hilo->claves[(r >> 8) % hilo->cantidad_claves];
+		if (r % 100 < hilo->lecturas){
+			hash_concurrente_obtener(hilo->hash, clave);
+		} else if (r & 0x80){
+			hash_concurrente_guardar(hilo->hash, clave, (void*) clave);
+		} else{
+			hash_concurrente_borrar(hilo->hash, clave);
+		}
+	}
+	return NULL;
+}
+
+typedef struct hilos_configuracion{
+	const char* nombre;
+	hash_concurrente_modo_t modo;
+	hash_tipo_t tipo;
+} hilos_configuracion_t;
+
+static double hilos_medir(const hilos_configuracion_t* configuracion, size_t fragmentos, size_t cantidad_hilos,
+		unsigned lecturas, char (*claves)[LARGO_CLAVE], size_t cantidad){
+	hash_concurrente_t* hash = hash_concurrente_crear_con_modo(NULL, configuracion->tipo, fragmentos, configuracion->modo);
+	// La mitad de las claves empieza guardada.
+	for (size_t i = 0; i < cantidad; i += 2){
+		hash_concurrente_guardar(hash, claves[i], claves[i]);
+	}
+	pthread_t hilos[MAX_HILOS];
+	hilo_benchmark_t datos[MAX_HILOS];
+	uint64_t inicio = ahora_ns();
+	for (size_t i = 0; i < cantidad_hilos; i++){
+		datos[i] = (hilo_benchmark_t) {hash, claves, cantidad, cantidad / cantidad_hilos, lecturas, 0x9e3779b97f4a7c15ULL * (i + 1)};
+		pthread_create(&hilos[i], NULL, hilo_operar, &datos[i]);
+	}
+	for (size_t i = 0; i < cantidad_hilos; i++){
+		pthread_join(hilos[i], NULL);
+	}
+	uint64_t total = ahora_ns() - inicio;
+	hash_concurrente_destruir(hash);
+	size_t operaciones = cantidad / cantidad_hilos * cantidad_hilos;
+	return (double) operaciones * 1000.0 / (double) total;
+}
+
+static void benchmark_hilos(size_t cantidad){
+	static const unsigned lecturas[] = {50, 90, 99};
+	static const hilos_configuracion_t configuraciones[] = {
+		{"abierto", HASH_CONCURRENTE_LOCKS, HASH_ABIERTO},
+		{"cerrado", HASH_CONCURRENTE_LOCKS, HASH_CERRADO},
+		{"libres", HASH_CONCURRENTE_LECTURAS_LIBRES, HASH_ABIERTO},
+	};
+	char (*claves)[LARGO_CLAVE] = claves_secuenciales(cantidad);
+	if (claves == NULL){
+		fprintf(stderr, "sin memoria\n");
+		return;
+	}
+	long procesadores = sysconf(_SC_NPROCESSORS_ONLN);
+	printf("# %zu operaciones en total, %ld procesadores; millones de operaciones por segundo\n", cantidad, procesadores);
+	printf("# fragmentos=1 equivale a un único mutex alrededor de un hash_t\n");
+	printf("# libres: HASH_CONCURRENTE_LECTURAS_LIBRES, las lecturas no toman locks\n");
+	printf("%-8s %9s %10s %6s %10s\n", "tipo", "lecturas", "fragmentos", "hilos", "Mops/s");
+	for (size_t c = 0; c < sizeof(configuraciones) / sizeof(configuraciones[0]); c++){
+		for (size_t l = 0; l < sizeof(lecturas) / sizeof(lecturas[0]); l++){
+			for (size_t fragmentos = 1; fragmentos <= 64; fragmentos *= 64){
+				for (size_t hilos = 1; hilos <= MAX_HILOS; hilos *= 2){
+					double mops = hilos_medir(&configuraciones[c], fragmentos, hilos, lecturas[l], claves, cantidad);
+					printf("%-8s %8u%% %10zu %6zu %10.2f\n", configuraciones[c].nombre,
+						lecturas[l], fragmentos, hilos, mops);
+				}
+			}
+		}
+	}
+	free(claves);
+}
+
+/* ******************************************************************
+ *                        CONSTRUCCIÓN EN PARALELO
+ * *****************************************************************/
+
+static void construir(hash_tipo_t tipo, const char** punteros, void** datos, size_t cantidad){
+	const char* nombre = tipo == HASH_CERRADO ? "cerrado" : "abierto";
+	uint64_t inicio = ahora_ns();
+	hash_t* hash = hash_crear_con_tipo(NULL, tipo);
+	for (size_t i = 0; i < cantidad; i++){
+		hash_guardar(hash, punteros[i], datos[i]);
+	}
+	uint64_t total = ahora_ns() - inicio;
+	hash_destruir(hash);
+	printf("%-8s %-16s %6s %10.1f\n", nombre, "hash_guardar", "-", (double) total / 1e6);
+	for (size_t hilos = 1; hilos <= MAX_HILOS; hilos *= 2){
+		inicio = ahora_ns();
+		hash = hash_construir(NULL, tipo, punteros, datos, cantidad, hilos);
+		total = ahora_ns() - inicio;
+		hash_destruir(hash);
+		printf("%-8s %-16s %6zu %10.1f\n", nombre, "hash_construir", hilos, (double) total / 1e6);
+	}
+}
+
+static void benchmark_construir(size_t cantidad){
+	char (*claves)[LARGO_CLAVE] = claves_secuenciales(cantidad);
+	const char** punteros = malloc(cantidad * sizeof(char*));
+	void** datos = malloc(cantidad * sizeof(void*));
+	if (claves == NULL || punteros == NULL || datos == NULL){
+		fprintf(stderr, "sin memoria\n");
+		free(claves);
+		free(punteros);
+		free(datos);
+		return;
+	}
+	for (size_t i = 0; i < cantidad; i++){
+		punteros[i] = claves[i];
+		datos[i] = claves[i];
+	}
+	long procesadores = sysconf(_SC_NPROCESSORS_ONLN);
+	printf("# %zu claves, %ld procesadores; ms para cargar todas\n", cantidad, procesadores);
+	printf("%-8s %-16s %6s %10s\n", "tipo", "forma", "hilos", "ms");
+	for (int tipo = HASH_ABIERTO; tipo <= HASH_CERRADO; tipo++){
+		construir((hash_tipo_t) tipo, punteros, datos, cantidad);
+	}
+	free(claves);
+	free(punteros);
+	free(datos);
+}
+
+/* ******************************************************************
+ *                        RECORRIDO COMPLETO
+ * *****************************************************************/
+
+static bool sumar_dato(const char* clave, void* dato, void* extra){
+	(void) clave;
+	__atomic_fetch_add((uint64_t*) extra, (uint64_t) (uintptr_t) dato, __ATOMIC_RELAXED);
+	return true;
+}
+
+// Suma por hilo, para no medir la contención sobre un único contador.
+static _Thread_local uint64_t suma_propia;
+
+static bool sumar_dato_propio(const char* clave, void* dato, void* extra){
+	(void) clave;
+	(void) extra;
+	suma_propia += (uint64_t) (uintptr_t) dato;
+	return true;
+}
+
+static void recorrer_medir(const hash_t* hash, const char* nombre, bool paralelo){
+	size_t pares = hash_cantidad(hash);
+	uint64_t suma = 0;
+	uint64_t inicio = ahora_ns();
+	hash_iter_t* iter = hash_iter_crear(hash);
+	for (; !hash_iter_al_final(iter); hash_iter_avanzar(iter)){
+		suma += (uint64_t) (uintptr_t) hash_obtener(hash, hash_iter_ver_actual(iter));
+	}
+	hash_iter_destruir(iter);
+	uint64_t total = ahora_ns() - inicio;
+	printf("%-17s %-22s %6s %8.2f\n", nombre, "iter + hash_obtener", "-", (double) total / (double) pares);
+	sumidero += suma;
+
+	suma = 0;
+	inicio = ahora_ns();
+	hash_iter_t en_pila;
+	for (hash_iter_iniciar(&en_pila, hash); !hash_iter_al_final(&en_pila); hash_iter_avanzar(&en_pila)){
+		suma += (uint64_t) (uintptr_t) hash_iter_ver_dato(&en_pila);
+	}
+	hash_iter_finalizar(&en_pila);
+	total = ahora_ns() - inicio;
+	printf("%-17s %-22s %6s %8.2f\n", nombre, "iter en pila + dato", "-", (double) total / (double) pares);
+	sumidero += suma;
+
+	inicio = ahora_ns();
+	suma_propia = 0;
+	hash_iterar(hash, sumar_dato_propio, NULL);
+	total = ahora_ns() - inicio;
+	printf("%-17s %-22s %6s %8.2f\n", nombre, "hash_iterar", "-", (double) total / (double) pares);
+	sumidero += suma_propia;
+
+	for (size_t hilos = 1; paralelo && hilos <= MAX_HILOS; hilos *= 2){
+		suma = 0;
+		inicio = ahora_ns();
+		hash_iterar_paralelo(hash, sumar_dato, &suma, hilos);
+		total = ahora_ns() - inicio;
+		printf("%-17s %-22s %6zu %8.2f\n", nombre, "hash_iterar_paralelo", hilos, (double) total / (double) pares);
+		sumidero += suma;
+	}
+}
+
+// Recorre la tabla llena y después de borrar 9 de cada 10 claves, cuando la
+// mayoría de los baldes quedan vacíos.
+static void recorrer(hash_tipo_t tipo, char (*claves)[LARGO_CLAVE], size_t cantidad){
+	bool cerrado = tipo == HASH_CERRADO;
+	hash_t* hash = hash_crear_con_tipo(NULL, tipo);
+	for (size_t i = 0; i < cantidad; i++){
+		hash_guardar(hash, claves[i], (void*) (uintptr_t) i);
+	}
+	recorrer_medir(hash, cerrado ? "cerrado" : "abierto", true);
+	for (size_t i = 0; i < cantidad; i++){
+		if (i % 10 != 0){
+			hash_borrar(hash, claves[i]);
+		}
+	}
+	recorrer_medir(hash, cerrado ? "cerrado disperso" : "abierto disperso", false);
+	hash_destruir(hash);
+}
+
+static void benchmark_recorrer(size_t cantidad){
+	char (*claves)[LARGO_CLAVE] = claves_secuenciales(cantidad);
+	if (claves == NULL){
+		fprintf(stderr, "sin memoria\n");
+		return;
+	}
+	printf("# %zu pares; ns por par para sumar todos los datos\n", cantidad);
+	printf("%-17s %-22s %6s %8s\n", "tipo", "forma", "hilos", "ns/par");
+	for (int tipo = HASH_ABIERTO; tipo <= HASH_CERRADO; tipo++){
+		recorrer((hash_tipo_t) tipo, claves, cantidad);
+	}
+	free(claves);
+}
+
+/* ******************************************************************
+ *                        IMÁGENES MAPEADAS
+ * *****************************************************************/
+
+#define RUTA_IMAGEN "hash_benchmark.img"
+
+// Compara volver a tener el hash disponible guardando todas las claves contra
+// abrir una imagen volcada, y la búsqueda sobre cada uno.
+static void volcado(hash_tipo_t tipo, char (*claves)[LARGO_CLAVE], size_t cantidad){
+	const char* nombre = tipo == HASH_CERRADO ? "cerrado" : "abierto";
+	uint64_t inicio = ahora_ns();
+	hash_t* hash = hash_crear_con_tipo(NULL, tipo);
+	for (size_t i = 0; i < cantidad; i++){
+		hash_guardar(hash, claves[i], (void*) (uintptr_t) i);
+	}
+	uint64_t total = ahora_ns() - inicio;
+	printf("%-8s %-24s %10.2f\n", nombre, "cargar (ms)", (double) total / 1e6);
+
+	inicio = ahora_ns();
+	bool ok = hash_volcar(hash, RUTA_IMAGEN);
+	total = ahora_ns() - inicio;
+	printf("%-8s %-24s %10.2f\n", nombre, "hash_volcar (ms)", (double) total / 1e6);
+
+	inicio = ahora_ns();
+	hash_t* mapeado = ok ? hash_abrir_mmap(RUTA_IMAGEN) : NULL;
+	total = ahora_ns() - inicio;
+	if (mapeado == NULL){
+		fprintf(stderr, "no se pudo volcar o abrir %s\n", RUTA_IMAGEN);
+		hash_destruir(hash);
+		return;
+	}
+	printf("%-8s %-24s %10.2f\n", nombre, "hash_abrir_mmap (ms)", (double) total / 1e6);
+
+	const hash_t* medidos[] = {hash, mapeado};
+	const char* formas[] = {"obtener en memoria (ns)", "obtener en imagen (ns)"};
+	for (size_t m = 0; m < 2; m++){
+		uint64_t suma = 0;
+		inicio = ahora_ns();
+		for (size_t i = 0; i < cantidad; i++){
+			suma += (uint64_t) (uintptr_t) hash_obtener(medidos[m], claves[(i * 7919) % cantidad]);
+		}
+		total = ahora_ns() - inicio;
+		printf("%-8s %-24s %10.2f\n", nombre, formas[m], (double) total / (double) cantidad);
+		sumidero += suma;
+	}
+	hash_destruir(mapeado);
+	hash_destruir(hash);
+	remove(RUTA_IMAGEN);
+}
+
+static void benchmark_volcado(size_t cantidad){
+	char (*claves)[LARGO_CLAVE] = claves_secuenciales(cantidad);
+	if (claves == NULL){
+		fprintf(stderr, "sin memoria\n");
+		return;
+	}
+	printf("# %zu pares\n", cantidad);
+	printf("%-8s %-24s %10s\n", "tipo", "medida", "valor");
+	for (int tipo = HASH_ABIERTO; tipo <= HASH_CERRADO; tipo++){
+		volcado((hash_tipo_t) tipo, claves, cantidad);
+	}
+	free(claves);
+}
+
+/* ******************************************************************
+ *                        SUITE COMPLETA
+ * *****************************************************************/
+
+// Para cada tipo de tabla, distribución de claves y cantidad mide guardar,
+// buscar claves presentes y ausentes, recorrer, borrar y una mezcla de
+// operaciones. Por ejemplo, para seguir la evolución entre versiones:
+//
+//     ./hash_benchmark suite 1000,1000000,100000000 csv > resultados.csv
+//
+// Claves y órdenes de acceso se generan antes de medir; ocupan unos 60
+// bytes por clave (6 GB con 100M claves), más la tabla.
+
+#define SUITE_CANTIDADES "1000,10000,100000,1000000"
+// Con tablas chicas se repite cada medición hasta llegar a estas operaciones.
+#define SUITE_OPERACIONES_MINIMAS 1000000
+// Se toma la latencia individual de una de cada tantas operaciones, para que
+// leer el reloj no pese en el total.
+#define SUITE_MUESTREO 16
+#define ZIPF_THETA 0.99
+
+// secuencial: claves "%08zu" guardadas y buscadas en orden.
+// uniforme: claves al azar, buscadas con la misma probabilidad.
+// zipf: las mismas claves, buscadas con una distribución de Zipf: unas pocas
+// concentran la mayoría de los accesos.
+typedef enum distribucion{
+	DISTRIBUCION_SECUENCIAL,
+	DISTRIBUCION_UNIFORME,
+	DISTRIBUCION_ZIPF
+} distribucion_t;
+
+static const char* const nombres_distribucion[] = {"secuencial", "uniforme", "zipf"};
+
+typedef enum operacion{
+	OPERACION_GUARDAR,
+	OPERACION_OBTENER,
+	OPERACION_AUSENTE,	// hash_pertenece de claves que no están.
+	OPERACION_ITERAR,	// Por par, con un iterador en la pila.
+	OPERACION_BORRAR,
+	OPERACION_MEZCLA,	// 50% obtener, 25% guardar, 25% borrar, con la tabla a medio llenar.
+	OPERACIONES
+} operacion_t;
+
+static const char* const nombres_operacion[] = {"guardar", "obtener", "ausente", "iterar", "borrar", "mezcla"};
+
+typedef enum formato{
+	FORMATO_TEXTO,
+	FORMATO_CSV,
+	FORMATO_JSON
+} formato_t;
+
+typedef struct carga{
+	char (*claves)[LARGO_CLAVE];	// cantidad claves a guardar, seguidas de cantidad que no se guardan.
+	uint32_t* orden;		// Orden de inserción y de borrado: una permutación.
+	uint32_t* accesos;		// Claves a buscar, según la distribución.
+	size_t cantidad;
+} carga_t;
+
+typedef struct medicion{
+	uint64_t* muestras;		// Latencias en ns; vacío para OPERACION_ITERAR.
+	size_t cant_muestras;
+	size_t operaciones;
+	uint64_t total;
+} medicion_t;
+
+static uint64_t splitmix(uint64_t x){
+	x += 0x9e3779b97f4a7c15ULL;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+// Generador de Zipf de Gray et al. ("Quickly generating billion-record
+// synthetic databases"), el mismo que usa YCSB. Devuelve rangos en
+// [0, cantidad), el 0 el más frecuente.
+typedef struct zipf{
+	double cantidad;
+	double alfa;
+	double zetan;
+	double eta;
+} zipf_t;
+
+static void zipf_iniciar(zipf_t* zipf, size_t cantidad){
+	double zetan = 0;
+	for (size_t i = 1; i <= cantidad; i++){
+		zetan += 1.0 / pow((double) i, ZIPF_THETA);
+	}
+	double zeta2 = 1.0 + pow(0.5, ZIPF_THETA);
+	zipf->cantidad = (double) cantidad;
+	zipf->alfa = 1.0 / (1.0 - ZIPF_THETA);
+	zipf->zetan = zetan;
+	zipf->eta = (1.0 - pow(2.0 / (double) cantidad, 1.0 - ZIPF_THETA)) / (1.0 - zeta2 / zetan);
+}
+
+static size_t zipf_siguiente(const zipf_t* zipf, uint64_t* estado){
+	double u = (double) (xorshift(estado) >> 11) * 0x1.0p-53;
+	double uz = u * zipf->zetan;
+	if (uz < 1.0){
+		return 0;
+	}
+	if (uz < 1.0 + pow(0.5, ZIPF_THETA)){
+		return 1;
+	}
+	size_t rango = (size_t) (zipf->cantidad * pow(zipf->eta * u - zipf->eta + 1.0, zipf->alfa));
+	return rango < (size_t) zipf->cantidad ? rango : (size_t) zipf->cantidad - 1;
+}
+
+static void carga_destruir(carga_t* carga){
+	free(carga->claves);
+	free(carga->orden);
+	free(carga->accesos);
+}
+
+static bool carga_crear(carga_t* carga, distribucion_t distribucion, size_t cantidad){
+	carga->cantidad = cantidad;
+	carga->claves = malloc(2 * cantidad * LARGO_CLAVE);
+	carga->orden = malloc(cantidad * sizeof(uint32_t));
+	carga->accesos = malloc(cantidad * sizeof(uint32_t));
+	if (carga->claves == NULL || carga->orden == NULL || carga->accesos == NULL){
+		carga_destruir(carga);
+		return false;
+	}
+	for (size_t i = 0; i < 2 * cantidad; i++){
+		if (distribucion == DISTRIBUCION_SECUENCIAL){
+			snprintf(carga->claves[i], LARGO_CLAVE, "%08zu", i);
+		} else{
+			snprintf(carga->claves[i], LARGO_CLAVE, "%016" PRIx64, splitmix(i));
+		}
+	}
+	uint64_t estado = 0x2545f4914f6cdd1dULL;
+	for (size_t i = 0; i < cantidad; i++){
+		carga->orden[i] = (uint32_t) i;
+	}
+	if (distribucion != DISTRIBUCION_SECUENCIAL){
+		for (size_t i = cantidad - 1; i > 0; i--){
+			size_t j = xorshift(&estado) % (i + 1);
+			uint32_t t = carga->orden[i];
+			carga->orden[i] = carga->orden[j];
+			carga->orden[j] = t;
+		}
+	}
+	zipf_t zipf;
+	if (distribucion == DISTRIBUCION_ZIPF){
+		zipf_iniciar(&zipf, cantidad);
+	}
+	for (size_t i = 0; i < cantidad; i++){
+		switch (distribucion){
+			case DISTRIBUCION_SECUENCIAL:
+				carga->accesos[i] = (uint32_t) i;
+				break;
+			case DISTRIBUCION_UNIFORME:
+				carga->accesos[i] = (uint32_t) (xorshift(&estado) % cantidad);
+				break;
+			case DISTRIBUCION_ZIPF:
+				// Los rangos pasan por la permutación para que las claves más
+				// buscadas no sean las primeras guardadas.
+				carga->accesos[i] = carga->orden[zipf_siguiente(&zipf, &estado)];
+				break;
+		}
+	}
+	return true;
+}
+
+static void suite_operar(hash_t* hash, operacion_t operacion, const carga_t* carga, size_t i, uint64_t* estado){
+	const char* clave;
+	switch (operacion){
+		case OPERACION_GUARDAR:
+			clave = carga->claves[carga->orden[i]];
+			hash_guardar(hash, clave, (void*) clave);
+			break;
+		case OPERACION_OBTENER:
+			sumidero += (uint64_t) (uintptr_t) hash_obtener(hash, carga->claves[carga->accesos[i]]);
+			break;
+		case OPERACION_AUSENTE:
+			sumidero += hash_pertenece(hash, carga->claves[carga->cantidad + carga->accesos[i]]);
+			break;
+		case OPERACION_BORRAR:
+			hash_borrar(hash, carga->claves[carga->orden[i]]);
+			break;
+		case OPERACION_MEZCLA:
+			clave = carga->claves[carga->accesos[i]];
+			switch (xorshift(estado) & 3){
+				case 0:
+				case 1:
+					sumidero += (uint64_t) (uintptr_t) hash_obtener(hash, clave);
+					break;
+				case 2:
+					hash_guardar(hash, clave, (void*) clave);
+					break;
+				default:
+					hash_borrar(hash, clave);
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+// Una pasada de la operación sobre todas las claves de la carga.
+static void suite_pasada(hash_t* hash, operacion_t operacion, const carga_t* carga, medicion_t* medicion, uint64_t* estado){
+	uint64_t inicio = ahora_ns();
+	if (operacion == OPERACION_ITERAR){
+		uint64_t suma = 0;
+		hash_iter_t iter;
+		for (hash_iter_iniciar(&iter, hash); !hash_iter_al_final(&iter); hash_iter_avanzar(&iter)){
+			suma += (uint64_t) (uintptr_t) hash_iter_ver_dato(&iter);
+		}
+		hash_iter_finalizar(&iter);
+		sumidero += suma;
+		medicion->total += ahora_ns() - inicio;
+		medicion->operaciones += hash_cantidad(hash);
+		return;
+	}
+	for (size_t i = 0; i < carga->cantidad; i++){
+		if (i % SUITE_MUESTREO != 0){
+			suite_operar(hash, operacion, carga, i, estado);
+			continue;
+		}
+		uint64_t t0 = ahora_ns();
+		suite_operar(hash, operacion, carga, i, estado);
+		medicion->muestras[medicion->cant_muestras++] = ahora_ns() - t0;
+	}
+	medicion->total += ahora_ns() - inicio;
+	medicion->operaciones += carga->cantidad;
+}
+
+typedef struct suite{
+	formato_t formato;
+	bool primero;		// Todavía no se imprimió ningún resultado.
+} suite_t;
+
+static void suite_imprimir(suite_t* suite, hash_tipo_t tipo, distribucion_t distribucion, size_t cantidad,
+		operacion_t operacion, medicion_t* medicion, double bytes_por_par){
+	const char* nombre_tipo = tipo == HASH_CERRADO ? "cerrado" : "abierto";
+	double ns = (double) medicion->total / (double) medicion->operaciones;
+	struct rusage uso;
+	getrusage(RUSAGE_SELF, &uso);
+	long rss = uso.ru_maxrss;
+	size_t n = medicion->cant_muestras;
+	uint64_t p50 = 0, p99 = 0, p999 = 0, max = 0;
+	if (n > 0){
+		qsort(medicion->muestras, n, sizeof(uint64_t), comparar_u64);
+		p50 = percentil(medicion->muestras, n, 50);
+		p99 = percentil(medicion->muestras, n, 99);
+		p999 = percentil(medicion->muestras, n, 99.9);
+		max = medicion->muestras[n - 1];
+	}
+	switch (suite->formato){
+		case FORMATO_TEXTO:
+			if (n == 0){
+				printf("%-8s %-10s %10zu %-8s %8.1f %8.2f %8s %8s %8s %10s %10ld %9.1f\n", nombre_tipo,
+					nombres_distribucion[distribucion], cantidad, nombres_operacion[operacion], ns, 1000.0 / ns,
+					"-", "-", "-", "-", rss, bytes_por_par);
+			} else{
+				printf("%-8s %-10s %10zu %-8s %8.1f %8.2f %8" PRIu64 " %8" PRIu64 " %8" PRIu64 " %10" PRIu64 " %10ld %9.1f\n",
+					nombre_tipo, nombres_distribucion[distribucion], cantidad, nombres_operacion[operacion], ns,
+					1000.0 / ns, p50, p99, p999, max, rss, bytes_por_par);
+			}
+			break;
+		case FORMATO_CSV:
+			printf("%s,%s,%zu,%s,%.2f,%.3f,", nombre_tipo, nombres_distribucion[distribucion], cantidad,
+				nombres_operacion[operacion], ns, 1000.0 / ns);
+			if (n > 0){
+				printf("%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64, p50, p99, p999, max);
+			} else{
+				printf(",,,");
+			}
+			printf(",%ld,%.1f\n", rss, bytes_por_par);
+			break;
+		case FORMATO_JSON:
+			printf("%s  {\"tipo\": \"%s\", \"distribucion\": \"%s\", \"cantidad\": %zu, \"operacion\": \"%s\", "
+				"\"ns_op\": %.2f, \"mops\": %.3f, ", suite->primero ? "" : ",\n", nombre_tipo,
+				nombres_distribucion[distribucion], cantidad, nombres_operacion[operacion], ns, 1000.0 / ns);
+			if (n > 0){
+				printf("\"p50_ns\": %" PRIu64 ", \"p99_ns\": %" PRIu64 ", \"p999_ns\": %" PRIu64 ", \"max_ns\": %" PRIu64 ", ",
+					p50, p99, p999, max);
+			} else{
+				printf("\"p50_ns\": null, \"p99_ns\": null, \"p999_ns\": null, \"max_ns\": null, ");
+			}
+			printf("\"rss_kb\": %ld, \"bytes_por_par\": %.1f}", rss, bytes_por_par);
+			break;
+	}
+	suite->primero = false;
+	fflush(stdout);
+}
+
+// Mide todas las operaciones para un tipo y una carga.
+static void suite_correr(suite_t* suite, hash_tipo_t tipo, distribucion_t distribucion, const carga_t* carga){
+	size_t cantidad = carga->cantidad;
+	size_t rondas = cantidad < SUITE_OPERACIONES_MINIMAS ? SUITE_OPERACIONES_MINIMAS / cantidad : 1;
+	medicion_t mediciones[OPERACIONES];
+	for (size_t o = 0; o < OPERACIONES; o++){
+		mediciones[o] = (medicion_t) {malloc((cantidad / SUITE_MUESTREO + 1) * rondas * sizeof(uint64_t)), 0, 0, 0};
+		if (mediciones[o].muestras == NULL){
+			fprintf(stderr, "sin memoria\n");
+			exit(1);
+		}
+	}
+	uint64_t estado = 0x9e3779b97f4a7c15ULL;
+	double bytes_por_par = 0;
+	for (size_t r = 0; r < rondas; r++){
+		hash_t* hash = hash_crear_con_tipo(NULL, tipo);
+		suite_pasada(hash, OPERACION_GUARDAR, carga, &mediciones[OPERACION_GUARDAR], &estado);
+		if (r == 0){
+			hash_estadisticas_t estadisticas;
+			hash_estadisticas(hash, &estadisticas);
+			size_t bytes = estadisticas.bytes_tabla + estadisticas.bytes_nodos + estadisticas.bytes_listas
+				+ estadisticas.bytes_claves;
+			bytes_por_par = (double) bytes / (double) estadisticas.cantidad;
+		}
+		suite_pasada(hash, OPERACION_OBTENER, carga, &mediciones[OPERACION_OBTENER], &estado);
+		suite_pasada(hash, OPERACION_AUSENTE, carga, &mediciones[OPERACION_AUSENTE], &estado);
+		suite_pasada(hash, OPERACION_ITERAR, carga, &mediciones[OPERACION_ITERAR], &estado);
+		suite_pasada(hash, OPERACION_BORRAR, carga, &mediciones[OPERACION_BORRAR], &estado);
+		// La mezcla arranca con la mitad de las claves, sin medir la carga.
+		for (size_t i = 0; i < cantidad; i += 2){
+			suite_operar(hash, OPERACION_GUARDAR, carga, i, &estado);
+		}
+		suite_pasada(hash, OPERACION_MEZCLA, carga, &mediciones[OPERACION_MEZCLA], &estado);
+		hash_destruir(hash);
+	}
+	for (size_t o = 0; o < OPERACIONES; o++){
+		suite_imprimir(suite, tipo, distribucion, cantidad, (operacion_t) o, &mediciones[o], bytes_por_par);
+		free(mediciones[o].muestras);
+	}
+}
+
+static void benchmark_suite(const char* cantidades, const char* nombre_formato){
+	suite_t suite = {FORMATO_TEXTO, true};
+	if (strcmp(nombre_formato, "csv") == 0){
+		suite.formato = FORMATO_CSV;
+	} else if (strcmp(nombre_formato, "json") == 0){
+		suite.formato = FORMATO_JSON;
+	} else if (strcmp(nombre_formato, "texto") != 0){
+		fprintf(stderr, "formato desconocido: %s\n", nombre_formato);
+		return;
+	}
+	switch (suite.formato){
+		case FORMATO_TEXTO:
+			printf("# ns/op y latencias en ns; las latencias son de una de cada %d operaciones e incluyen\n"
+				"# leer el reloj; rss_kb: pico del proceso hasta ese momento; bytes/par: memoria de la\n"
+				"# tabla después de guardar todo\n", SUITE_MUESTREO);
+			printf("%-8s %-10s %10s %-8s %8s %8s %8s %8s %8s %10s %10s %9s\n", "tipo", "distrib", "cantidad",
+				"op", "ns/op", "Mops/s", "p50", "p99", "p99.9", "max", "rss_kb", "bytes/par");
+			break;
+		case FORMATO_CSV:
+			printf("tipo,distribucion,cantidad,operacion,ns_op,mops,p50_ns,p99_ns,p999_ns,max_ns,rss_kb,bytes_por_par\n");
+			break;
+		case FORMATO_JSON:
+			printf("[\n");
+			break;
+	}
+	// Las cantidades conviene darlas de menor a mayor, para que el pico de
+	// memoria corresponda a la última.
+	const char* resto = cantidades;
+	while (*resto != '\0'){
+		char* fin;
+		size_t cantidad = (size_t) strtoull(resto, &fin, 10);
+		if (fin == resto || cantidad == 0 || cantidad > UINT32_MAX){
+			fprintf(stderr, "cantidad invalida: %s\n", resto);
+			break;
+		}
+		resto = *fin == ',' ? fin + 1 : fin;
+		for (int distribucion = DISTRIBUCION_SECUENCIAL; distribucion <= DISTRIBUCION_ZIPF; distribucion++){
+			carga_t carga;
+			if (!carga_crear(&carga, (distribucion_t) distribucion, cantidad)){
+				fprintf(stderr, "sin memoria para %zu claves\n", cantidad);
+				continue;
+			}
+			for (int tipo = HASH_ABIERTO; tipo <= HASH_CERRADO; tipo++){
+				suite_correr(&suite, (hash_tipo_t) tipo, (distribucion_t) distribucion, &carga);
+			}
+			carga_destruir(&carga);
+		}
+	}
+	if (suite.formato == FORMATO_JSON){
+		printf("\n]\n");
+	}
+}
+
+/* ******************************************************************
+ *                        CLAVES ENTERAS
+ * *****************************************************************/
+
+// Identificadores de 64 bits, guardados y buscados como texto "%08" con
+// hash_t (incluido el formateo) y directamente con hash_u64_t.
+static void benchmark_enteros(size_t cantidad){
+	uint64_t* ids = malloc(cantidad * sizeof(uint64_t));
+	if (ids == NULL){
+		fprintf(stderr, "sin memoria\n");
+		return;
+	}
+	for (size_t i = 0; i < cantidad; i++){
+		ids[i] = splitmix(i) >> 32;
+	}
+	printf("# %zu identificadores; ns por operación\n", cantidad);
+	printf("%-8s %10s %10s\n", "tipo", "guardar", "obtener");
+	char clave[LARGO_CLAVE];
+	for (int tipo = HASH_ABIERTO; tipo <= HASH_CERRADO; tipo++){
+		hash_t* hash = hash_crear_con_tipo(NULL, (hash_tipo_t) tipo);
+		uint64_t inicio = ahora_ns();
+		for (size_t i = 0; i < cantidad; i++){
+			snprintf(clave, sizeof(clave), "%08" PRIu64, ids[i]);
+			hash_guardar(hash, clave, (void*) (uintptr_t) i);
+		}
+		uint64_t guardar = ahora_ns() - inicio;
+		uint64_t suma = 0;
+		inicio = ahora_ns();
+		for (size_t i = 0; i < cantidad; i++){
+			snprintf(clave, sizeof(clave), "%08" PRIu64, ids[(i * 7919) % cantidad]);
+			suma += (uint64_t) (uintptr_t) hash_obtener(hash, clave);
+		}
+		uint64_t obtener = ahora_ns() - inicio;
+		sumidero += suma;
+		printf("%-8s %10.1f %10.1f\n", tipo == HASH_CERRADO ? "cerrado" : "abierto",
+			(double) guardar / (double) cantidad, (double) obtener / (double) cantidad);
+		hash_destruir(hash);
+	}
+	hash_u64_t* hash = hash_u64_crear(NULL);
+	uint64_t inicio = ahora_ns();
+	for (size_t i = 0; i < cantidad; i++){
+		hash_u64_guardar(hash, ids[i], (void*) (uintptr_t) i);
+	}
+	uint64_t guardar = ahora_ns() - inicio;
+	uint64_t suma = 0;
+	inicio = ahora_ns();
+	for (size_t i = 0; i < cantidad; i++){
+		suma += (uint64_t) (uintptr_t) hash_u64_obtener(hash, ids[(i * 7919) % cantidad]);
+	}
+	uint64_t obtener = ahora_ns() - inicio;
+	sumidero += suma;
+	printf("%-8s %10.1f %10.1f\n", "u64", (double) guardar / (double) cantidad, (double) obtener / (double) cantidad);
+	hash_u64_destruir(hash);
+	free(ids);
+}
+
+/* ******************************************************************
+ *                        FILTRO
+ * *****************************************************************/
+
+// Búsquedas donde 9 de cada 10 claves no están, con y sin el filtro de
+// hash_filtro_activar.
+static void benchmark_filtro(size_t cantidad){
+	char (*claves)[LARGO_CLAVE] = claves_secuenciales(2 * cantidad);
+	if (claves == NULL){
+		fprintf(stderr, "sin memoria\n");
+		return;
+	}
+	printf("# %zu pares, 90%% de búsquedas ausentes; ns por hash_pertenece\n", cantidad);
+	printf("%-8s %-8s %10s %12s %10s\n", "tipo", "filtro", "pertenece", "bytes filtro", "fp medido");
+	for (int tipo = HASH_ABIERTO; tipo <= HASH_CERRADO; tipo++){
+		hash_t* hash = hash_crear_con_tipo(NULL, (hash_tipo_t) tipo);
+		for (size_t i = 0; i < cantidad; i++){
+			hash_guardar(hash, claves[i], NULL);
+		}
+		for (int filtro = 0; filtro <= 1; filtro++){
+			hash_filtro_activar(hash, filtro);
+			uint64_t encontradas = 0;
+			uint64_t inicio = ahora_ns();
+			for (size_t i = 0; i < cantidad; i++){
+				size_t j = (i * 7919) % cantidad;
+				encontradas += hash_pertenece(hash, claves[i % 10 == 0 ? j : cantidad + j]);
+			}
+			uint64_t total = ahora_ns() - inicio;
+			sumidero += encontradas;
+			hash_estadisticas_t estadisticas;
+			hash_estadisticas(hash, &estadisticas);
+			printf("%-8s %-8s %10.1f %12zu %9.3f%%\n", tipo == HASH_CERRADO ? "cerrado" : "abierto",
+				filtro ? "si" : "no", (double) total / (double) cantidad, estadisticas.bytes_filtro,
+				100 * estadisticas.filtro_tasa_medida);
+		}
+		hash_destruir(hash);
+	}
+	free(claves);
+}
+
+/* ******************************************************************
+ *                        CACHE
+ * *****************************************************************/
+
+// Accesos con distribución de Zipf a cantidad claves: cada fallo guarda la
+// clave, como al leer de una fuente más lenta. Compara caches de distintas
+// capacidades con un hash cerrado sin límite.
+static void benchmark_cache(size_t cantidad){
+	char (*claves)[LARGO_CLAVE] = claves_secuenciales(cantidad);
+	size_t cant_accesos = 4 * cantidad;
+	size_t* accesos = malloc(cant_accesos * sizeof(size_t));
+	if (claves == NULL || accesos == NULL){
+		fprintf(stderr, "sin memoria\n");
+		free(claves);
+		free(accesos);
+		return;
+	}
+	zipf_t zipf;
+	zipf_iniciar(&zipf, cantidad);
+	uint64_t estado = 42;
+	for (size_t i = 0; i < cant_accesos; i++){
+		// Mezcla los rangos para que las claves frecuentes no sean contiguas.
+		accesos[i] = splitmix(zipf_siguiente(&zipf, &estado)) % cantidad;
+	}
+	printf("# %zu claves, %zu accesos zipf\n", cantidad, cant_accesos);
+	printf("%-12s %12s %10s %10s\n", "capacidad", "ns/acceso", "aciertos", "desalojos");
+	size_t divisores[] = {100, 10, 0};
+	for (size_t d = 0; d < sizeof(divisores) / sizeof(divisores[0]); d++){
+		size_t capacidad = divisores[d] ? cantidad / divisores[d] : 0;
+		hash_t* hash = capacidad ? hash_crear_cache(capacidad, NULL) : hash_crear_con_tipo(NULL, HASH_CERRADO);
+		size_t aciertos = 0;
+		uint64_t inicio = ahora_ns();
+		for (size_t i = 0; i < cant_accesos; i++){
+			char* clave = claves[accesos[i]];
+			if (hash_obtener(hash, clave) != NULL){
+				aciertos++;
+			} else{
+				hash_guardar(hash, clave, clave);
+			}
+		}
+		uint64_t total = ahora_ns() - inicio;
+		hash_estadisticas_t estadisticas;
+		hash_estadisticas(hash, &estadisticas);
+		char nombre[32];
+		snprintf(nombre, sizeof(nombre), "%zu", capacidad);
+		printf("%-12s %12.1f %9.1f%% %10zu\n", capacidad ? nombre : "sin límite", (double) total / (double) cant_accesos,
+			100.0 * (double) aciertos / (double) cant_accesos, estadisticas.cache_desalojos);
+		hash_destruir(hash);
+	}
+	free(accesos);
+	free(claves);
+}
+
+/* ******************************************************************
+ *                        VENCIMIENTOS
+ * *****************************************************************/
+
+static uint64_t ahora_ttl;
+
+static uint64_t reloj_ttl(void){
+	return ahora_ttl;
+}
+
+// Tablas de tamaños crecientes donde en cada tick vence una centésima parte de
+// las claves, con vencimientos repartidos a lo largo de 100 ticks. Compara
+// hash_expirar con recorrer la tabla entera con el iterador buscando las
+// vencidas, que es lo que habría que hacer sin la rueda: el costo por tick del
+// primero crece con lo que vence y el del segundo con el tamaño de la tabla.
+static void benchmark_ttl(size_t cantidad){
+	printf("%-10s %12s %14s %14s\n", "cantidad", "vencidas", "expirar ns", "recorrer ns");
+	for (size_t tam = cantidad / 64 ? cantidad / 64 : 1; tam <= cantidad; tam *= 4){
+		char (*claves)[LARGO_CLAVE] = claves_secuenciales(tam);
+		uint64_t* vence = malloc(tam * sizeof(uint64_t));
+		hash_t* hash = hash_crear_con_tipo(NULL, HASH_CERRADO);
+		if (claves == NULL || vence == NULL || hash == NULL){
+			fprintf(stderr, "sin memoria\n");
+			free(claves);
+			free(vence);
+			hash_destruir(hash);
+			return;
+		}
+		hash_ttl_reloj(hash, reloj_ttl);
+		ahora_ttl = 0;
+		for (size_t i = 0; i < tam; i++){
+			vence[i] = 1 + splitmix(i) % 100;
+			hash_guardar_con_ttl(hash, claves[i], &vence[i], vence[i]);
+		}
+
+		// Sin rueda: en cada tick se recorre todo para encontrar lo vencido.
+		uint64_t recorrer = 0;
+		size_t encontradas = 0;
+		for (uint64_t tick = 1; tick <= 10; tick++){
+			uint64_t inicio = ahora_ns();
+			hash_iter_t* iter = hash_iter_crear(hash);
+			for (; !hash_iter_al_final(iter); hash_iter_avanzar(iter)){
+				const uint64_t* vencimiento = hash_obtener(hash, hash_iter_ver_actual(iter));
+				encontradas += vencimiento != NULL && *vencimiento == tick;
+			}
+			hash_iter_destruir(iter);
+			recorrer += ahora_ns() - inicio;
+		}
+
+		uint64_t expirar = 0;
+		size_t vencidas = 0;
+		for (uint64_t tick = 1; tick <= 10; tick++){
+			ahora_ttl = tick;
+			uint64_t inicio = ahora_ns();
+			size_t expirados;
+			do{
+				expirados = hash_expirar(hash, tick);
+				vencidas += expirados;
+			} while (expirados == HASH_EXPIRAR_LOTE);
+			expirar += ahora_ns() - inicio;
+		}
+		if (vencidas != encontradas){
+			fprintf(stderr, "ttl: expiraron %zu, el recorrido encontró %zu\n", vencidas, encontradas);
+		}
+		printf("%-10zu %12zu %14.1f %14.1f\n", tam, vencidas / 10, (double) expirar / 10, (double) recorrer / 10);
+		hash_destruir(hash);
+		free(vence);
+		free(claves);
+	}
+}
+
+/* ******************************************************************
+ *                        PROGRAMA PRINCIPAL
+ * *****************************************************************/
+
+int main(int argc, char* argv[]){
+	if (argc < 2){
+		fprintf(stderr, "uso: %s latencia|rotacion|funciones|conteo|lote|hilos|construir|recorrer|volcado|enteros|filtro|cache|ttl [cantidad]\n"
+			"     %s suite [cantidad,cantidad,...] [texto|csv|json]\n", argv[0], argv[0]);
+		return 1;
+	}
+	if (strcmp(argv[1], "suite") == 0){
+		benchmark_suite(argc > 2 ? argv[2] : SUITE_CANTIDADES, argc > 3 ? argv[3] : "texto");
+		return 0;
+	}
+	size_t cantidad = argc > 2 ? (size_t) strtoull(argv[2], NULL, 10) : 1000000;
+	if (strcmp(argv[1], "latencia") == 0){
+		benchmark_latencia(cantidad);
+		return 0;
+	}
+	if (strcmp(argv[1], "rotacion") == 0){
+		benchmark_rotacion(cantidad);
+		return 0;
+	}
+	if (strcmp(argv[1], "funciones") == 0){
+		benchmark_funciones(cantidad);
+		return 0;
+	}
+	if (strcmp(argv[1], "conteo") == 0){
+		benchmark_conteo(cantidad);
+		return 0;
+	}
+	if (strcmp(argv[1], "lote") == 0){
+		benchmark_lote(cantidad);
+		return 0;
+	}
+	if (strcmp(argv[1], "hilos") == 0){
+		benchmark_hilos(cantidad);
+		return 0;
+	}
+	if (strcmp(argv[1], "construir") == 0){
+		benchmark_construir(cantidad);
+		return 0;
+	}
+	if (strcmp(argv[1], "recorrer") == 0){
+		benchmark_recorrer(cantidad);
+		return 0;
+	}
+	if (strcmp(argv[1], "volcado") == 0){
+		benchmark_volcado(cantidad);
+		return 0;
+	}
+	if (strcmp(argv[1], "enteros") == 0){
+		benchmark_enteros(cantidad);
+		return 0;
+	}
+	if (strcmp(argv[1], "filtro") == 0){
+		benchmark_filtro(cantidad);
+		return 0;
+	}
+	if (strcmp(argv[1], "cache") == 0){
+		benchmark_cache(cantidad);
+		return 0;
+	}
+	if (strcmp(argv[1], "ttl") == 0){
+		benchmark_ttl(cantidad);
+		return 0;
+	}
+	fprintf(stderr, "benchmark desconocido: %s\n", argv[1]);
+	return 1;
+}
@@ -0,0 +1,399 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "hash_concurrente.h"
+#include "epoca.h"
+
+#ifdef __linux__
+#include <sys/random.h>
+#endif
+
+#define FRAGMENTOS_POR_DEFECTO 64
+// Cada fragmento ocupa su propia línea de caché, para que los locks de
+// fragmentos vecinos no se invaliden entre sí.
+#define LINEA_CACHE 64
+// Constante de Fibonacci de 64 bits, para elegir el fragmento.
+#define DISPERSION 0x9E3779B97F4A7C15ULL
+// Modo de lecturas libres: baldes iniciales por fragmento y factor de carga
+// a partir del cual se duplica la tabla.
+#define CAPACIDAD_INICIAL 16
+#define CARGA_MAXIMA 2
+
+// ********** Definiciones **********
+
+// Entrada de una tabla compartida. Sólo los escritores la modifican, con el
+// lock del fragmento tomado; los lectores la recorren sin lock.
+typedef struct entrada{
+	_Atomic(struct entrada*) sig;
+	_Atomic(void*) dato;
+	uint64_t hash;
+	size_t largo;
+	char clave[];
+} entrada_t;
+
+typedef struct tabla_compartida{
+	size_t capacidad;	// Potencia de 2.
+	_Atomic(entrada_t*) baldes[];
+} tabla_compartida_t;
+
+typedef struct fragmento{
+	_Alignas(LINEA_CACHE) pthread_mutex_t mutex;
+	hash_t* hash;					// HASH_CONCURRENTE_LOCKS.
+	_Atomic(tabla_compartida_t*) tabla;	// HASH_CONCURRENTE_LECTURAS_LIBRES.
+	size_t elementos;				// Ídem; sólo con el lock tomado.
+} fragmento_t;
+
+struct hash_concurrente{
+	fragmento_t* fragmentos;
+	size_t cantidad;	// Potencia de 2.
+	unsigned bits;		// log2(cantidad).
+	uint64_t semilla;	// Para elegir fragmento; con locks, también la de cada hash_t.
+	hash_concurrente_modo_t modo;
+	hash_destruir_dato_t destruir_dato;	// Sólo la usa el modo de lecturas libres.
+};
+
+// ********** Auxiliares **********
+
+static uint64_t semilla_nueva(const hash_concurrente_t* hash){
+	uint64_t semilla;
+#ifdef __linux__
+	if (getrandom(&semilla, sizeof(semilla), GRND_NONBLOCK) == (ssize_t) sizeof(semilla)){
+		return semilla;
+	}
+#endif
+	semilla = (uint64_t) time(NULL) ^ (uint64_t) (uintptr_t) hash;
+	return hash_funcion_wyhash(&semilla, sizeof(semilla), 0);
+}
+
+// Calcula el hash de la clave, lo deja en h y devuelve el fragmento que le
+// toca según los bits altos de h multiplicado por DISPERSION. Con locks, cada
+// hash_t tiene la misma semilla y usa h sin volver a calcularlo; con lecturas
+// libres, sus bits bajos eligen el balde. La multiplicación hace que las
+// claves de un fragmento no compartan los bits altos de h, que el hash_t
+// también usa.
+static fragmento_t* fragmento_y_hash(const hash_concurrente_t* hash, const char* clave, size_t largo, uint64_t* h){
+	*h = hash_funcion_wyhash(clave, largo, hash->semilla);
+	if (hash->bits == 0){
+		return &hash->fragmentos[0];
+	}
+	return &hash->fragmentos[(*h * DISPERSION) >> (64 - hash->bits)];
+}
+
+static tabla_compartida_t* tabla_crear(size_t capacidad){
+	tabla_compartida_t* tabla = malloc(sizeof(tabla_compartida_t) + capacidad * sizeof(_Atomic(entrada_t*)));
+	if (tabla == NULL){
+		return NULL;
+	}
+	tabla->capacidad = capacidad;
+	for (size_t i = 0; i < capacidad; i++){
+		atomic_init(&tabla->baldes[i], NULL);
+	}
+	return tabla;
+}
+
+// Libera la tabla y las entradas que siguen enlazadas en ella, sin tocar los
+// datos. Se usa como función de epoca_retirar para la tabla vieja de una
+// redimensión, cuyas entradas ya fueron copiadas a la nueva.
+static void tabla_liberar(void* dato){
+	tabla_compartida_t* tabla = dato;
+	for (size_t i = 0; i < tabla->capacidad; i++){
+		entrada_t* entrada = atomic_load_explicit(&tabla->baldes[i], memory_order_relaxed);
+		while (entrada != NULL){
+			entrada_t* sig = atomic_load_explicit(&entrada->sig, memory_order_relaxed);
+			free(entrada);
+			entrada = sig;
+		}
+	}
+	free(tabla);
+}
+
+static void tabla_destruir(tabla_compartida_t* tabla, hash_destruir_dato_t destruir_dato){
+	if (destruir_dato != NULL){
+		for (size_t i = 0; i < tabla->capacidad; i++){
+			entrada_t* entrada = atomic_load_explicit(&tabla->baldes[i], memory_order_relaxed);
+			for (; entrada != NULL; entrada = atomic_load_explicit(&entrada->sig, memory_order_relaxed)){
+				destruir_dato(atomic_load_explicit(&entrada->dato, memory_order_relaxed));
+			}
+		}
+	}
+	tabla_liberar(tabla);
+}
+
+static entrada_t* entrada_crear(const char* clave, size_t largo, uint64_t h, void* dato){
+	entrada_t* entrada = malloc(sizeof(entrada_t) + largo + 1);
+	if (entrada == NULL){
+		return NULL;
+	}
+	atomic_init(&entrada->sig, NULL);
+	atomic_init(&entrada->dato, dato);
+	entrada->hash = h;
+	entrada->largo = largo;
+	memcpy(entrada->clave, clave, largo + 1);
+	return entrada;
+}
+
+static bool entrada_es(const entrada_t* entrada, const char* clave, size_t largo, uint64_t h){
+	return entrada->hash == h && entrada->largo == largo && memcmp(entrada->clave, clave, largo) == 0;
+}
+
+// Búsqueda de los lectores: sin lock, dentro de una época.
+static entrada_t* tabla_buscar(fragmento_t* fragmento, const char* clave, size_t largo, uint64_t h){
+	tabla_compartida_t* tabla = atomic_load_explicit(&fragmento->tabla, memory_order_acquire);
+	entrada_t* entrada = atomic_load_explicit(&tabla->baldes[h & (tabla->capacidad - 1)], memory_order_acquire);
+	while (entrada != NULL && !entrada_es(entrada, clave, largo, h)){
+		entrada = atomic_load_explicit(&entrada->sig, memory_order_acquire);
+	}
+	return entrada;
+}
+
+// Duplica la tabla del fragmento. Las entradas se copian en vez de
+// reenlazarse, porque puede haber lectores recorriendo las cadenas viejas.
+// Si falta memoria se queda con la tabla actual, que sigue siendo válida.
+// Pre: El lock del fragmento está tomado.
+static void tabla_redimensionar(fragmento_t* fragmento){
+	tabla_compartida_t* vieja = atomic_load_explicit(&fragmento->tabla, memory_order_relaxed);
+	tabla_compartida_t* nueva = tabla_crear(vieja->capacidad * 2);
+	if (nueva == NULL){
+		return;
+	}
+	for (size_t i = 0; i < vieja->capacidad; i++){
+		entrada_t* entrada = atomic_load_explicit(&vieja->baldes[i], memory_order_relaxed);
+		for (; entrada != NULL; entrada = atomic_load_explicit(&entrada->sig, memory_order_relaxed)){
+			void* dato = atomic_load_explicit(&entrada->dato, memory_order_relaxed);
+			entrada_t* copia = entrada_crear(entrada->clave, entrada->largo, entrada->hash, dato);
+			if (copia == NULL){
+				tabla_liberar(nueva);
+				return;
+			}
+			_Atomic(entrada_t*)* balde = &nueva->baldes[copia->hash & (nueva->capacidad - 1)];
+			atomic_store_explicit(&copia->sig, atomic_load_explicit(balde, memory_order_relaxed), memory_order_relaxed);
+			atomic_store_explicit(balde, copia, memory_order_relaxed);
+		}
+	}
+	atomic_store_explicit(&fragmento->tabla, nueva, memory_order_release);
+	epoca_retirar(tabla_liberar, vieja);
+}
+
+static void fragmentos_destruir(hash_concurrente_t* hash, size_t cantidad){
+	for (size_t i = 0; i < cantidad; i++){
+		fragmento_t* fragmento = &hash->fragmentos[i];
+		if (hash->modo == HASH_CONCURRENTE_LOCKS){
+			hash_destruir(fragmento->hash);
+		}else{
+			tabla_destruir(atomic_load_explicit(&fragmento->tabla, memory_order_relaxed), hash->destruir_dato);
+		}
+		pthread_mutex_destroy(&fragmento->mutex);
+	}
+	free(hash->fragmentos);
+	free(hash);
+}
+
+// ********** Modo de lecturas libres **********
+
+static bool libres_guardar(hash_concurrente_t* hash, const char* clave, void* dato){
+	size_t largo = strlen(clave);
+	uint64_t h;
+	fragmento_t* fragmento = fragmento_y_hash(hash, clave, largo, &h);
+	pthread_mutex_lock(&fragmento->mutex);
+	tabla_compartida_t* tabla = atomic_load_explicit(&fragmento->tabla, memory_order_relaxed);
+	_Atomic(entrada_t*)* balde = &tabla->baldes[h & (tabla->capacidad - 1)];
+	entrada_t* entrada = atomic_load_explicit(balde, memory_order_relaxed);
+	while (entrada != NULL && !entrada_es(entrada, clave, largo, h)){
+		entrada = atomic_load_explicit(&entrada->sig, memory_order_relaxed);
+	}
+	if (entrada != NULL){
+		void* anterior = atomic_exchange_explicit(&entrada->dato, dato, memory_order_acq_rel);
+		pthread_mutex_unlock(&fragmento->mutex);
+		// Un lector puede estar usando el dato viejo dentro de su época.
+		if (hash->destruir_dato != NULL){
+			epoca_retirar(hash->destruir_dato, anterior);
+		}
+		return true;
+	}
+	entrada = entrada_crear(clave, largo, h, dato);
+	if (entrada == NULL){
+		pthread_mutex_unlock(&fragmento->mutex);
+		return false;
+	}
+	atomic_store_explicit(&entrada->sig, atomic_load_explicit(balde, memory_order_relaxed), memory_order_relaxed);
+	// Publica la entrada ya inicializada.
+	atomic_store_explicit(balde, entrada, memory_order_release);
+	if (++fragmento->elementos > tabla->capacidad * CARGA_MAXIMA){
+		tabla_redimensionar(fragmento);
+	}
+	pthread_mutex_unlock(&fragmento->mutex);
+	return true;
+}
+
+static void* libres_borrar(hash_concurrente_t* hash, const char* clave){
+	size_t largo = strlen(clave);
+	uint64_t h;
+	fragmento_t* fragmento = fragmento_y_hash(hash, clave, largo, &h);
+	pthread_mutex_lock(&fragmento->mutex);
+	tabla_compartida_t* tabla = atomic_load_explicit(&fragmento->tabla, memory_order_relaxed);
+	_Atomic(entrada_t*)* enlace = &tabla->baldes[h & (tabla->capacidad - 1)];
+	entrada_t* entrada = atomic_load_explicit(enlace, memory_order_relaxed);
+	while (entrada != NULL && !entrada_es(entrada, clave, largo, h)){
+		enlace = &entrada->sig;
+		entrada = atomic_load_explicit(enlace, memory_order_relaxed);
+	}
+	if (entrada == NULL){
+		pthread_mutex_unlock(&fragmento->mutex);
+		return NULL;
+	}
+	// Los lectores que ya estaban en la entrada siguen por su sig, que no cambia.
+	atomic_store_explicit(enlace, atomic_load_explicit(&entrada->sig, memory_order_relaxed), memory_order_release);
+	fragmento->elementos--;
+	void* dato = atomic_load_explicit(&entrada->dato, memory_order_relaxed);
+	pthread_mutex_unlock(&fragmento->mutex);
+	epoca_retirar(free, entrada);
+	return dato;
+}
+
+static void* libres_obtener(hash_concurrente_t* hash, const char* clave, bool* pertenece){
+	size_t largo = strlen(clave);
+	uint64_t h;
+	fragmento_t* fragmento = fragmento_y_hash(hash, clave, largo, &h);
+	epoca_entrar();
+	entrada_t* entrada = tabla_buscar(fragmento, clave, largo, h);
+	void* dato = entrada != NULL ? atomic_load_explicit(&entrada->dato, memory_order_acquire) : NULL;
+	epoca_salir();
+	*pertenece = entrada != NULL;
+	return dato;
+}
+
+// ********** Primitivas **********
+
+hash_concurrente_t *hash_concurrente_crear(hash_destruir_dato_t destruir_dato, hash_tipo_t tipo, size_t fragmentos){
+	return hash_concurrente_crear_con_modo(destruir_dato, tipo, fragmentos, HASH_CONCURRENTE_LOCKS);
+}
+
+hash_concurrente_t *hash_concurrente_crear_con_modo(hash_destruir_dato_t destruir_dato, hash_tipo_t tipo, size_t fragmentos, hash_concurrente_modo_t modo){
+	hash_concurrente_t* hash = malloc(sizeof(hash_concurrente_t));
+	if (hash == NULL){
+		return NULL;
+	}
+	hash->modo = modo;
+	hash->destruir_dato = destruir_dato;
+	if (fragmentos == 0){
+		fragmentos = FRAGMENTOS_POR_DEFECTO;
+	}
+	hash->cantidad = 1;
+	hash->bits = 0;
+	while (hash->cantidad < fragmentos){
+		hash->cantidad *= 2;
+		hash->bits++;
+	}
+	hash->semilla = semilla_nueva(hash);
+	hash->fragmentos = aligned_alloc(LINEA_CACHE, hash->cantidad * sizeof(fragmento_t));
+	if (hash->fragmentos == NULL){
+		free(hash);
+		return NULL;
+	}
+	for (size_t i = 0; i < hash->cantidad; i++){
+		fragmento_t* fragmento = &hash->fragmentos[i];
+		fragmento->hash = NULL;
+		fragmento->elementos = 0;
+		tabla_compartida_t* tabla = NULL;
+		if (modo == HASH_CONCURRENTE_LOCKS){
+			fragmento->hash = hash_crear_con_semilla(destruir_dato, tipo, hash_funcion_wyhash, hash->semilla);
+		}else{
+			tabla = tabla_crear(CAPACIDAD_INICIAL);
+		}
+		atomic_init(&fragmento->tabla, tabla);
+		if (fragmento->hash == NULL && tabla == NULL){
+			fragmentos_destruir(hash, i);
+			return NULL;
+		}
+		if (pthread_mutex_init(&fragmento->mutex, NULL) != 0){
+			if (modo == HASH_CONCURRENTE_LOCKS){
+				hash_destruir(fragmento->hash);
+			}else{
+				tabla_liberar(tabla);
+			}
+			fragmentos_destruir(hash, i);
+			return NULL;
+		}
+	}
+	return hash;
+}
+
+bool hash_concurrente_guardar(hash_concurrente_t *hash, const char *clave, void *dato){
+	if (hash->modo == HASH_CONCURRENTE_LECTURAS_LIBRES){
+		return libres_guardar(hash, clave, dato);
+	}
+	size_t largo = strlen(clave);
+	uint64_t h;
+	fragmento_t* fragmento = fragmento_y_hash(hash, clave, largo, &h);
+	pthread_mutex_lock(&fragmento->mutex);
+	bool ok = hash_guardar_con_hash(fragmento->hash, clave, largo, h, dato);
+	pthread_mutex_unlock(&fragmento->mutex);
+	return ok;
+}
+
+void *hash_concurrente_borrar(hash_concurrente_t *hash, const char *clave){
+	if (hash->modo == HASH_CONCURRENTE_LECTURAS_LIBRES){
+		return libres_borrar(hash, clave);
+	}
+	size_t largo = strlen(clave);
+	uint64_t h;
+	fragmento_t* fragmento = fragmento_y_hash(hash, clave, largo, &h);
+	pthread_mutex_lock(&fragmento->mutex);
+	void* dato = hash_borrar_con_hash(fragmento->hash, clave, largo, h);
+	pthread_mutex_unlock(&fragmento->mutex);
+	return dato;
+}
+
+void *hash_concurrente_obtener(hash_concurrente_t *hash, const char *clave){
+	if (hash->modo == HASH_CONCURRENTE_LECTURAS_LIBRES){
+		bool pertenece;
+		return libres_obtener(hash, clave, &pertenece);
+	}
+	// hash_obtener puede avanzar una redimensión incremental, así que también
+	// necesita el lock exclusivo.
+	size_t largo = strlen(clave);
+	uint64_t h;
+	fragmento_t* fragmento = fragmento_y_hash(hash, clave, largo, &h);
+	pthread_mutex_lock(&fragmento->mutex);
+	void* dato = hash_obtener_con_hash(fragmento->hash, clave, largo, h);
+	pthread_mutex_unlock(&fragmento->mutex);
+	return dato;
+}
+
+bool hash_concurrente_pertenece(hash_concurrente_t *hash, const char *clave){
+	if (hash->modo == HASH_CONCURRENTE_LECTURAS_LIBRES){
+		bool pertenece;
+		libres_obtener(hash, clave, &pertenece);
+		return pertenece;
+	}
+	size_t largo = strlen(clave);
+	uint64_t h;
+	fragmento_t* fragmento = fragmento_y_hash(hash, clave, largo, &h);
+	pthread_mutex_lock(&fragmento->mutex);
+	bool pertenece = hash_pertenece_con_hash(fragmento->hash, clave, largo, h);
+	pthread_mutex_unlock(&fragmento->mutex);
+	return pertenece;
+}
+
+size_t hash_concurrente_cantidad(hash_concurrente_t *hash){
+	size_t cantidad = 0;
+	for (size_t i = 0; i < hash->cantidad; i++){
+		fragmento_t* fragmento = &hash->fragmentos[i];
+		pthread_mutex_lock(&fragmento->mutex);
+		cantidad += hash->modo == HASH_CONCURRENTE_LOCKS ? hash_cantidad(fragmento->hash) : fragmento->elementos;
+		pthread_mutex_unlock(&fragmento->mutex);
+	}
+	return cantidad;
+}
+
+void hash_concurrente_destruir(hash_concurrente_t *hash){
+	if (hash->modo == HASH_CONCURRENTE_LECTURAS_LIBRES){
+		// Termina de liberar los datos reemplazados y las entradas y tablas
+		// retiradas antes de destruir lo que queda.
+		epoca_sincronizar();
+	}
+	fragmentos_destruir(hash, hash->cantidad);
+}
@@ -0,0 +1,80 @@
+#ifndef HASH_CONCURRENTE_H
+#define HASH_CONCURRENTE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "hash.h"
+
+// Hash que se puede usar desde varios hilos a la vez. Las claves se reparten
+// entre varios fragmentos según los bits altos de su hash; cada fragmento es
+// un hash_t con su propio lock, y se redimensiona por su cuenta.
+struct hash_concurrente;
+typedef struct hash_concurrente hash_concurrente_t;
+
+// HASH_CONCURRENTE_LOCKS: cada operación toma el lock de su fragmento.
+// HASH_CONCURRENTE_LECTURAS_LIBRES: para tablas que se leen mucho más de lo
+// que se modifican. hash_concurrente_obtener y hash_concurrente_pertenece no
+// toman locks ni hacen operaciones atómicas de lectura-escritura: los
+// escritores (que sí toman el lock del fragmento) publican entradas y tablas
+// nuevas con semántica release, y lo que reemplazan o borran se libera por
+// épocas (ver epoca.h). Los datos reemplazados por hash_concurrente_guardar
+// también se destruyen por épocas, así que un lector que envuelva la búsqueda
+// y el uso del dato entre epoca_entrar y epoca_salir lo puede usar sin que
+// se destruya mientras tanto.
+typedef enum hash_concurrente_modo {
+    HASH_CONCURRENTE_LOCKS,
+    HASH_CONCURRENTE_LECTURAS_LIBRES
+} hash_concurrente_modo_t;
+
+/* Crea el hash con la implementación indicada y la cantidad de fragmentos
+ * pedida, redondeada hacia arriba a una potencia de 2 (0 para la cantidad
+ * por defecto). Con más fragmentos que hilos, es raro que dos hilos esperen
+ * por el mismo lock. Usa HASH_CONCURRENTE_LOCKS.
+ */
+hash_concurrente_t *hash_concurrente_crear(hash_destruir_dato_t destruir_dato, hash_tipo_t tipo, size_t fragmentos);
+
+/* Igual que hash_concurrente_crear, con el modo indicado. Con
+ * HASH_CONCURRENTE_LECTURAS_LIBRES cada fragmento es una tabla de baldes
+ * encadenados propia y tipo se ignora.
+ */
+hash_concurrente_t *hash_concurrente_crear_con_modo(hash_destruir_dato_t destruir_dato, hash_tipo_t tipo, size_t fragmentos, hash_concurrente_modo_t modo);
+
+/* Igual que hash_guardar. Con HASH_CONCURRENTE_LOCKS destruir_dato se llama
+ * con el lock del fragmento tomado; con HASH_CONCURRENTE_LECTURAS_LIBRES se
+ * llama más tarde, desde el hilo que libere lo retirado.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_concurrente_guardar(hash_concurrente_t *hash, const char *clave, void *dato);
+
+/* Igual que hash_borrar.
+ * Pre: La estructura hash fue inicializada
+ */
+void *hash_concurrente_borrar(hash_concurrente_t *hash, const char *clave);
+
+/* Igual que hash_obtener. El dato devuelto deja de estar protegido por el
+ * lock: si otro hilo puede borrarlo o reemplazarlo mientras se usa, la
+ * sincronización queda a cargo del usuario.
+ * Pre: La estructura hash fue inicializada
+ */
+void *hash_concurrente_obtener(hash_concurrente_t *hash, const char *clave);
+
+/* Igual que hash_pertenece.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_concurrente_pertenece(hash_concurrente_t *hash, const char *clave);
+
+/* Devuelve la cantidad de elementos. Con otros hilos modificando el hash, es
+ * la suma de lo que tenía cada fragmento al momento de contarlo.
+ * Pre: La estructura hash fue inicializada
+ */
+size_t hash_concurrente_cantidad(hash_concurrente_t *hash);
+
+/* Destruye la estructura como hash_destruir. Con
+ * HASH_CONCURRENTE_LECTURAS_LIBRES antes espera a que terminen las lecturas
+ * en curso de cualquier hash y destruye los datos reemplazados pendientes.
+ * Pre: La estructura hash fue inicializada y ningún otro hilo la está usando
+ * Post: La estructura hash fue destruida
+ */
+void hash_concurrente_destruir(hash_concurrente_t *hash);
+
+#endif  // HASH_CONCURRENTE_H
@@ -6,7 +6,13 @@
  */
 
 #include "hash.h"
+#include "hash_concurrente.h"
+#include "hash_tipado.h"
+#include "hash_u64.h"
+#include "epoca.h"
 #include "testing.h"
+#include <pthread.h>
+#include <stdatomic.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -392,6 +398,1430 @@ static void prueba_hash_iterar_volumen(size_t largo)
     hash_destruir(hash);
 }
 
+static void prueba_hash_cerrado_volumen(size_t largo)
+{
+    hash_t* hash = hash_crear_con_tipo(NULL, HASH_CERRADO);
+    print_test("Prueba hash cerrado crear", hash);
+
+    const size_t largo_clave = 10;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+    size_t* valores = malloc(largo * sizeof(size_t));
+
+    bool ok = true;
+    for (unsigned i = 0; i < largo && ok; i++) {
+        sprintf(claves[i], "%08d", i);
+        valores[i] = i;
+        ok = hash_guardar(hash, claves[i], &valores[i]);
+    }
+    print_test("Prueba hash cerrado almacenar muchos elementos", ok);
+
+    /* Borra las claves pares, dejando posiciones borradas en la tabla */
+    for (size_t i = 0; i < largo && ok; i += 2) {
+        ok = hash_borrar(hash, claves[i]) == &valores[i];
+    }
+    print_test("Prueba hash cerrado borrar la mitad", ok);
+    print_test("Prueba hash cerrado la cantidad es la mitad", hash_cantidad(hash) == largo / 2);
+
+    for (size_t i = 0; i < largo && ok; i++) {
+        ok = hash_pertenece(hash, claves[i]) == (i % 2 == 1);
+    }
+    print_test("Prueba hash cerrado pertenece solo impares", ok);
+
+    /* Reinserta las pares sobre las posiciones borradas */
+    for (size_t i = 0; i < largo && ok; i += 2) {
+        ok = hash_guardar(hash, claves[i], &valores[i]);
+    }
+    for (size_t i = 0; i < largo && ok; i++) {
+        ok = hash_obtener(hash, claves[i]) == &valores[i];
+    }
+    print_test("Prueba hash cerrado reinsertar y obtener", ok);
+
+    size_t recorridos = 0;
+    hash_iter_t* iter = hash_iter_crear(hash);
+    for (; !hash_iter_al_final(iter); hash_iter_avanzar(iter)) {
+        recorridos++;
+    }
+    hash_iter_destruir(iter);
+    print_test("Prueba hash cerrado iterar recorre todo", recorridos == largo);
+
+    free(claves);
+    free(valores);
+    hash_destruir(hash);
+}
+
+static void prueba_hash_incremental(hash_tipo_t tipo, size_t largo)
+{
+    hash_t* hash = hash_crear_con_tipo(NULL, tipo);
+    print_test("Prueba hash incremental activar", hash_redimension_incremental(hash, true));
+
+    const size_t largo_clave = 10;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+    size_t* valores = malloc(largo * sizeof(size_t));
+
+    /* Cada inserción puede dejar una migración a medias: se verifica todo lo
+     * guardado hasta el momento a intervalos */
+    bool ok = true;
+    for (unsigned i = 0; i < largo && ok; i++) {
+        sprintf(claves[i], "%08d", i);
+        valores[i] = i;
+        ok = hash_guardar(hash, claves[i], &valores[i]);
+        for (size_t j = 0; ok && i % 97 == 0 && j <= i; j++) {
+            ok = hash_obtener(hash, claves[j]) == &valores[j];
+        }
+    }
+    print_test("Prueba hash incremental guardar y obtener durante migraciones", ok);
+    print_test("Prueba hash incremental la cantidad es correcta", hash_cantidad(hash) == largo);
+
+    /* El iterador ve cada clave una sola vez aunque haya una migración en
+     * curso y se llame a hash_obtener mientras itera */
+    size_t recorridos = 0;
+    hash_iter_t* iter = hash_iter_crear(hash);
+    for (; !hash_iter_al_final(iter) && ok; hash_iter_avanzar(iter)) {
+        size_t* valor = hash_obtener(hash, hash_iter_ver_actual(iter));
+        ok = valor != NULL && *valor != largo;
+        if (ok) *valor = largo;
+        recorridos++;
+    }
+    hash_iter_destruir(iter);
+    print_test("Prueba hash incremental iterar sin repetir", ok && recorridos == largo);
+
+    for (size_t i = 0; i < largo && ok; i++) {
+        ok = hash_borrar(hash, claves[i]) == &valores[i];
+    }
+    print_test("Prueba hash incremental borrar todo", ok);
+    print_test("Prueba hash incremental la cantidad es 0", hash_cantidad(hash) == 0);
+    print_test("Prueba hash incremental desactivar", hash_redimension_incremental(hash, false));
+
+    free(claves);
+    free(valores);
+    hash_destruir(hash);
+}
+
+static void prueba_hash_rotacion_claves(hash_tipo_t tipo, size_t largo)
+{
+    hash_t* hash = hash_crear_con_tipo(NULL, tipo);
+
+    const size_t largo_clave = 10;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+    size_t* valores = malloc(largo * sizeof(size_t));
+
+    bool ok = true;
+    for (unsigned i = 0; i < largo && ok; i++) {
+        sprintf(claves[i], "%08d", i);
+        valores[i] = i;
+        ok = hash_guardar(hash, claves[i], &valores[i]);
+    }
+
+    /* Borra 3 de cada 4 claves: las copias vigentes se reubican para
+     * recuperar la memoria de las borradas */
+    for (size_t i = 0; i < largo && ok; i++) {
+        if (i % 4 != 0) ok = hash_borrar(hash, claves[i]) == &valores[i];
+    }
+    print_test("Prueba hash rotacion borrar tres cuartos", ok);
+    for (size_t i = 0; i < largo && ok; i++) {
+        ok = hash_obtener(hash, claves[i]) == (i % 4 == 0 ? &valores[i] : NULL);
+    }
+    print_test("Prueba hash rotacion obtener los que quedan", ok);
+
+    hash_iter_t* iter = hash_iter_crear(hash);
+    for (; !hash_iter_al_final(iter) && ok; hash_iter_avanzar(iter)) {
+        const char* clave = hash_iter_ver_actual(iter);
+        size_t* valor = hash_obtener(hash, clave);
+        ok = valor != NULL && strcmp(clave, claves[*valor]) == 0;
+    }
+    hash_iter_destruir(iter);
+    print_test("Prueba hash rotacion iterar claves validas", ok);
+
+    for (size_t i = 0; i < largo && ok; i++) {
+        if (i % 4 != 0) ok = hash_guardar(hash, claves[i], &valores[i]);
+    }
+    for (size_t i = 0; i < largo && ok; i++) {
+        ok = hash_obtener(hash, claves[i]) == &valores[i];
+    }
+    print_test("Prueba hash rotacion reinsertar y obtener todo", ok);
+
+    free(claves);
+    free(valores);
+    hash_destruir(hash);
+}
+
+/* Función de hashing que hace colisionar todas las claves */
+static uint64_t hash_constante(const void* clave, size_t largo, uint64_t semilla)
+{
+    (void) clave;
+    (void) largo;
+    (void) semilla;
+    return 42;
+}
+
+static void prueba_hash_funcion(hash_tipo_t tipo, hash_funcion_t funcion, size_t largo)
+{
+    hash_t* hash = hash_crear_con_funcion(NULL, tipo, funcion);
+
+    const size_t largo_clave = 10;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+    size_t* valores = malloc(largo * sizeof(size_t));
+
+    bool ok = true;
+    for (unsigned i = 0; i < largo && ok; i++) {
+        sprintf(claves[i], "%08d", i);
+        valores[i] = i;
+        ok = hash_guardar(hash, claves[i], &valores[i]);
+    }
+    print_test("Prueba hash funcion propia almacenar", ok);
+    for (size_t i = 0; i < largo && ok; i++) {
+        ok = hash_obtener(hash, claves[i]) == &valores[i];
+    }
+    print_test("Prueba hash funcion propia obtener", ok);
+    for (size_t i = 0; i < largo && ok; i += 2) {
+        ok = hash_borrar(hash, claves[i]) == &valores[i];
+    }
+    for (size_t i = 0; i < largo && ok; i++) {
+        ok = hash_pertenece(hash, claves[i]) == (i % 2 == 1);
+    }
+    print_test("Prueba hash funcion propia borrar la mitad", ok);
+    print_test("Prueba hash funcion propia la cantidad es correcta", hash_cantidad(hash) == largo / 2);
+
+    free(claves);
+    free(valores);
+    hash_destruir(hash);
+}
+
+/* Dos hashes con la misma semilla calculan lo mismo, y las primitivas con el
+ * hash ya calculado equivalen a las comunes */
+static void prueba_hash_con_hash(hash_tipo_t tipo, size_t largo)
+{
+    hash_t* hash = hash_crear_con_semilla(NULL, tipo, NULL, 1234);
+    hash_t* otro = hash_crear_con_semilla(NULL, tipo, NULL, 1234);
+    char clave[16];
+    bool ok = true;
+    for (unsigned i = 0; i < largo; i++) {
+        sprintf(clave, "%08u", i);
+        uint64_t h = hash_calcular(hash, clave, strlen(clave));
+        ok &= h == hash_calcular(otro, clave, strlen(clave));
+        ok &= hash_guardar_con_hash(hash, clave, strlen(clave), h, &largo);
+    }
+    print_test("Prueba hash con hash guardar", ok && hash_cantidad(hash) == largo);
+    for (unsigned i = 0; i < largo; i++) {
+        sprintf(clave, "%08u", i);
+        uint64_t h = hash_calcular(hash, clave, strlen(clave));
+        ok &= hash_obtener(hash, clave) == &largo && hash_obtener_con_hash(hash, clave, strlen(clave), h) == &largo;
+        if (i % 2 == 0) {
+            ok &= hash_borrar_con_hash(hash, clave, strlen(clave), h) == &largo;
+        }
+        ok &= hash_pertenece_con_hash(hash, clave, strlen(clave), h) == (i % 2 == 1);
+    }
+    print_test("Prueba hash con hash obtener y borrar", ok && hash_cantidad(hash) == largo / 2);
+    hash_destruir(otro);
+    hash_destruir(hash);
+}
+
+/* Suma las entradas del histograma, pesadas por su índice si pesar */
+static size_t histograma_sumar(const hash_estadisticas_t* estadisticas, bool pesar)
+{
+    size_t suma = 0;
+    for (size_t i = 0; i < HASH_ESTADISTICAS_LARGOS; i++) {
+        suma += estadisticas->histograma[i] * (pesar ? i : 1);
+    }
+    return suma;
+}
+
+static void prueba_hash_estadisticas(hash_tipo_t tipo, size_t largo)
+{
+    hash_t* hash = hash_crear_con_tipo(NULL, tipo);
+    bool abierto = tipo == HASH_ABIERTO;
+    hash_estadisticas_t estadisticas;
+
+    hash_estadisticas(hash, &estadisticas);
+    print_test("Prueba hash estadisticas vacio",
+               estadisticas.cantidad == 0 && estadisticas.capacidad > 0 && estadisticas.factor_de_carga == 0
+               && estadisticas.redimensiones == 0 && estadisticas.distancia_maxima == 0);
+    print_test("Prueba hash estadisticas vacio histograma",
+               histograma_sumar(&estadisticas, false) == (abierto ? estadisticas.capacidad : 0));
+
+    /* Claves largas, para que se copien a la arena */
+    const size_t largo_clave = 40;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+    for (unsigned i = 0; i < largo; i++) {
+        sprintf(claves[i], "clave de estadisticas %016u", i);
+        hash_guardar(hash, claves[i], NULL);
+    }
+    hash_estadisticas(hash, &estadisticas);
+    print_test("Prueba hash estadisticas cantidad y carga",
+               estadisticas.cantidad == largo && estadisticas.redimensiones > 0
+               && estadisticas.factor_de_carga == (double) largo / (double) estadisticas.capacidad);
+    /* Abierto: cada balde cuenta una vez y sus pares suman la cantidad.
+     * Cerrado: cada par cuenta una vez */
+    print_test("Prueba hash estadisticas histograma",
+               abierto ? histograma_sumar(&estadisticas, false) == estadisticas.capacidad
+                         && histograma_sumar(&estadisticas, true) == largo
+                       : histograma_sumar(&estadisticas, false) == largo);
+    print_test("Prueba hash estadisticas distancias",
+               estadisticas.distancia_media < 2 && estadisticas.distancia_maxima < largo);
+    print_test("Prueba hash estadisticas memoria",
+               estadisticas.bytes_claves >= largo * (largo_clave - 1) && estadisticas.bytes_tabla > 0
+               && (estadisticas.bytes_nodos > 0) == abierto && estadisticas.bytes_claves_sin_uso == 0);
+    for (size_t i = 0; i < largo; i += 2) {
+        hash_borrar(hash, claves[i]);
+    }
+    hash_estadisticas(hash, &estadisticas);
+    print_test("Prueba hash estadisticas despues de borrar",
+               estadisticas.cantidad == largo - (largo + 1) / 2 && estadisticas.bytes_claves_sin_uso > 0
+               && (abierto || estadisticas.borrados > 0));
+    hash_destruir(hash);
+
+    /* Con una función que hace colisionar todo, las distancias lo muestran */
+    hash = hash_crear_con_funcion(NULL, tipo, hash_constante);
+    for (size_t i = 0; i < 100; i++) {
+        hash_guardar(hash, claves[i], NULL);
+    }
+    hash_estadisticas(hash, &estadisticas);
+    print_test("Prueba hash estadisticas con colisiones",
+               estadisticas.distancia_maxima == 99 && estadisticas.distancia_media == 49.5);
+    hash_destruir(hash);
+    free(claves);
+}
+
+/* Claves de todos los largos alrededor del límite para guardarlas dentro del
+ * nodo, mezcladas para que las redimensiones y la compactación de la arena
+ * muevan unas y otras */
+static void prueba_hash_claves_largos(hash_tipo_t tipo, size_t largo)
+{
+    hash_t* hash = hash_crear_con_tipo(NULL, tipo);
+    const size_t largo_clave = 48;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+    size_t* valores = malloc(largo * sizeof(size_t));
+    for (size_t i = 0; i < largo; i++) {
+        /* Un prefijo único de 8 bytes completado con 'x' hasta i % 40 bytes */
+        size_t n = i % 40;
+        char prefijo[17];
+        sprintf(prefijo, "%08zx", i);
+        memset(claves[i], 'x', n);
+        memcpy(claves[i], prefijo, n < 8 ? n : 8);
+        claves[i][n] = '\0';
+        valores[i] = i;
+    }
+    /* Las claves de menos de 8 bytes se repiten: queda el último dato */
+    bool ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        ok &= hash_guardar(hash, claves[i], &valores[i]);
+    }
+    for (size_t i = 0; i < largo; i++) {
+        size_t* dato = hash_obtener(hash, claves[i]);
+        ok &= dato != NULL && strcmp(claves[*dato], claves[i]) == 0;
+    }
+    print_test("Prueba hash claves de todos los largos guardar y obtener", ok);
+
+    hash_iter_t iter;
+    size_t recorridos = 0;
+    ok = true;
+    for (hash_iter_iniciar(&iter, hash); !hash_iter_al_final(&iter); hash_iter_avanzar(&iter)) {
+        const char* clave = hash_iter_ver_actual(&iter);
+        size_t* dato = hash_iter_ver_dato(&iter);
+        ok &= strlen(clave) == hash_iter_ver_largo(&iter) && strcmp(clave, claves[*dato]) == 0;
+        recorridos++;
+    }
+    hash_iter_finalizar(&iter);
+    print_test("Prueba hash claves de todos los largos iterar", ok && recorridos == hash_cantidad(hash));
+
+    /* Borra casi todas las largas para que la arena se compacte */
+    for (size_t i = 0; i < largo; i++) {
+        if (i % 40 >= 8 && i % 5 != 0) {
+            ok &= hash_borrar(hash, claves[i]) == &valores[i];
+        }
+    }
+    for (size_t i = 0; i < largo; i++) {
+        bool borrada = i % 40 >= 8 && i % 5 != 0;
+        ok &= hash_pertenece(hash, claves[i]) != borrada;
+    }
+    print_test("Prueba hash claves de todos los largos borrar", ok);
+
+    free(claves);
+    free(valores);
+    hash_destruir(hash);
+}
+
+/* Reservar evita las redimensiones al guardar y pone un piso al achicar;
+ * borrar achica con histéresis y compactar deja la menor tabla posible */
+static void prueba_hash_capacidad(hash_tipo_t tipo, size_t largo)
+{
+    hash_t* hash = hash_crear_con_tipo(NULL, tipo);
+    hash_estadisticas_t estadisticas;
+    const size_t largo_clave = 40;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+    for (unsigned i = 0; i < largo; i++) {
+        sprintf(claves[i], "clave de capacidad %016u", i);
+    }
+
+    print_test("Prueba hash capacidad reservar", hash_reservar(hash, largo));
+    hash_estadisticas(hash, &estadisticas);
+    size_t capacidad = estadisticas.capacidad;
+    size_t redimensiones = estadisticas.redimensiones;
+    bool ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        ok &= hash_guardar(hash, claves[i], claves[i]);
+    }
+    hash_estadisticas(hash, &estadisticas);
+    print_test("Prueba hash capacidad guardar lo reservado no redimensiona",
+               ok && estadisticas.capacidad == capacidad && estadisticas.redimensiones == redimensiones);
+
+    /* Con la reserva puesta, borrar casi todo no achica */
+    size_t quedan = largo / 16;
+    for (size_t i = quedan; i < largo; i++) {
+        ok &= hash_borrar(hash, claves[i]) == claves[i];
+    }
+    hash_estadisticas(hash, &estadisticas);
+    print_test("Prueba hash capacidad no achica bajo la reserva", ok && estadisticas.capacidad == capacidad);
+
+    /* Sin reserva, borrar achica de una vez hasta que sobre la mitad */
+    print_test("Prueba hash capacidad quitar la reserva", hash_reservar(hash, 0));
+    while (estadisticas.capacidad == capacidad && quedan > 0) {
+        quedan--;
+        ok &= hash_borrar(hash, claves[quedan]) == claves[quedan];
+        hash_estadisticas(hash, &estadisticas);
+    }
+    hash_t* justo = hash_crear_con_tipo(NULL, tipo);
+    for (size_t i = 0; i < 2 * quedan; i++) {
+        ok &= hash_guardar(justo, claves[i], NULL);
+    }
+    hash_estadisticas_t minimas;
+    hash_estadisticas(justo, &minimas);
+    hash_destruir(justo);
+    print_test("Prueba hash capacidad achica al borrar", ok && estadisticas.capacidad == minimas.capacidad);
+
+    /* Recién achicada, guardar y borrar la misma clave no redimensiona cada vez */
+    capacidad = estadisticas.capacidad;
+    redimensiones = estadisticas.redimensiones;
+    for (size_t i = 0; i < 1000; i++) {
+        ok &= hash_guardar(hash, claves[quedan], claves[quedan]);
+        ok &= hash_borrar(hash, claves[quedan]) == claves[quedan];
+    }
+    hash_estadisticas(hash, &estadisticas);
+    print_test("Prueba hash capacidad histeresis",
+               ok && estadisticas.capacidad == capacidad && estadisticas.redimensiones == redimensiones);
+
+    /* Borrar de a uno achica de a poco; lo que queda sigue estando */
+    for (size_t i = quedan / 8; i < quedan; i++) {
+        ok &= hash_borrar(hash, claves[i]) == claves[i];
+    }
+    quedan /= 8;
+    for (size_t i = 0; i < quedan; i++) {
+        ok &= hash_obtener(hash, claves[i]) == claves[i];
+    }
+    hash_estadisticas(hash, &estadisticas);
+    print_test("Prueba hash capacidad achica varias veces", ok && hash_cantidad(hash) == quedan
+               && estadisticas.capacidad < capacidad);
+    hash_destruir(hash);
+
+    /* Compactar: la misma tabla que si se hubieran guardado sólo los que quedan */
+    justo = hash_crear_con_tipo(NULL, tipo);
+    hash = hash_crear_con_tipo(NULL, tipo);
+    hash_filtro_activar(hash, true);
+    for (size_t i = 0; i < largo; i++) {
+        ok &= hash_guardar(hash, claves[i], claves[i]);
+    }
+    quedan = largo / 3;
+    for (size_t i = quedan; i < largo; i++) {
+        ok &= hash_borrar(hash, claves[i]) == claves[i];
+    }
+    for (size_t i = 0; i < quedan; i++) {
+        ok &= hash_guardar(justo, claves[i], claves[i]);
+    }
+    hash_estadisticas_t antes;
+    hash_estadisticas(hash, &antes);
+    print_test("Prueba hash capacidad compactar", ok && hash_compactar(hash));
+    hash_estadisticas(justo, &minimas);
+    hash_estadisticas(hash, &estadisticas);
+    print_test("Prueba hash capacidad compactar tabla", estadisticas.capacidad == minimas.capacidad
+               && estadisticas.borrados == 0 && estadisticas.bytes_tabla <= antes.bytes_tabla);
+    print_test("Prueba hash capacidad compactar memoria", estadisticas.bytes_claves_sin_uso == 0
+               && estadisticas.bytes_claves < antes.bytes_claves && estadisticas.bytes_nodos <= antes.bytes_nodos
+               && estadisticas.bytes_filtro <= antes.bytes_filtro);
+    for (size_t i = 0; i < largo; i++) {
+        ok &= hash_obtener(hash, claves[i]) == (i < quedan ? claves[i] : NULL);
+    }
+    print_test("Prueba hash capacidad compactar conserva los pares", ok && hash_cantidad(hash) == quedan);
+    for (size_t i = quedan; i < largo; i++) {
+        ok &= hash_guardar(hash, claves[i], claves[i]);
+    }
+    print_test("Prueba hash capacidad guardar despues de compactar", ok && hash_cantidad(hash) == largo);
+
+    hash_destruir(justo);
+    hash_destruir(hash);
+    free(claves);
+}
+
+/* El cache no pasa de su capacidad, desaloja con CLOCK los pares que no se
+ * buscaron y destruye sus datos */
+static void prueba_hash_cache(size_t largo)
+{
+    print_test("Prueba hash cache sin capacidad", !hash_crear_cache(0, NULL));
+    const size_t capacidad = 100;
+    hash_t* cache = hash_crear_cache(capacidad, free);
+    hash_estadisticas_t estadisticas;
+    const size_t largo_clave = 40;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+    for (unsigned i = 0; i < largo; i++) {
+        sprintf(claves[i], "clave de cache %024u", i);
+    }
+    print_test("Prueba hash cache sin incremental", !hash_redimension_incremental(cache, true));
+
+    bool ok = true;
+    for (size_t i = 0; i < capacidad; i++) {
+        size_t* dato = malloc(sizeof(size_t));
+        *dato = i;
+        ok &= hash_guardar(cache, claves[i], dato);
+    }
+    hash_estadisticas(cache, &estadisticas);
+    print_test("Prueba hash cache lleno", ok && hash_cantidad(cache) == capacidad
+               && estadisticas.cache_capacidad == capacidad && estadisticas.cache_desalojos == 0);
+
+    /* Las buscadas sobreviven a la mitad que se desaloja */
+    for (size_t i = 0; i < capacidad / 2; i++) {
+        size_t* dato = hash_obtener(cache, claves[i]);
+        ok &= dato && *dato == i;
+    }
+    ok &= !hash_obtener(cache, claves[largo - 1]);
+    for (size_t i = capacidad; i < capacidad + capacidad / 2; i++) {
+        ok &= hash_guardar(cache, claves[i], malloc(sizeof(size_t)));
+    }
+    for (size_t i = 0; i < capacidad / 2; i++) {
+        ok &= hash_pertenece(cache, claves[i]);
+    }
+    hash_estadisticas(cache, &estadisticas);
+    print_test("Prueba hash cache desaloja las no buscadas", ok && hash_cantidad(cache) == capacidad);
+    print_test("Prueba hash cache contadores", estadisticas.cache_aciertos == capacidad / 2
+               && estadisticas.cache_fallos == 1 && estadisticas.cache_desalojos == capacidad / 2);
+
+    /* Muchas claves de una sola vez no desplazan a las que se buscan seguido,
+     * ni agrandan la tabla o la memoria de claves */
+    for (size_t i = 0; i < 10; i++) {
+        ok &= hash_obtener(cache, claves[i]) != NULL;
+    }
+    hash_estadisticas(cache, &estadisticas);
+    size_t capacidad_tabla = estadisticas.capacidad;
+    size_t aciertos = estadisticas.cache_aciertos;
+    size_t buscadas = 0;
+    for (size_t i = 2 * capacidad; i < largo - 1; i++) {
+        ok &= hash_guardar(cache, claves[i], malloc(sizeof(size_t)));
+        ok &= hash_cantidad(cache) <= capacidad;
+        if (i % 4 == 0) {
+            hash_obtener(cache, claves[i / 4 % 10]);
+            buscadas++;
+        }
+    }
+    hash_estadisticas(cache, &estadisticas);
+    print_test("Prueba hash cache recorrido", ok && hash_cantidad(cache) == capacidad);
+    print_test("Prueba hash cache conserva las frecuentes",
+               estadisticas.cache_aciertos - aciertos == buscadas);
+    print_test("Prueba hash cache no crece", estadisticas.capacidad == capacidad_tabla
+               && estadisticas.bytes_claves < largo * largo_clave / 4);
+
+    /* Borrar y reemplazar siguen funcionando */
+    size_t* dato = hash_borrar(cache, claves[0]);
+    ok = dato && *dato == 0;
+    free(dato);
+    ok &= hash_guardar(cache, claves[1], malloc(sizeof(size_t)));
+    print_test("Prueba hash cache borrar y reemplazar", ok && hash_cantidad(cache) == capacidad - 1);
+
+    hash_destruir(cache);
+    free(claves);
+}
+
+/* Reloj de las pruebas de vencimientos, que avanza sólo cuando se lo cambia */
+static uint64_t ahora_prueba;
+
+static uint64_t reloj_prueba(void)
+{
+    return ahora_prueba;
+}
+
+/* Vencimiento de la clave i: varios sin vencer, algunos vencidos al
+ * guardarlos, y el resto repartido desde unidades hasta más allá del alcance
+ * de la rueda */
+static uint64_t ttl_prueba(size_t i)
+{
+    const uint64_t escalas[] = {0, 10, 1000, 100000, 10000000, 1ULL << 40, UINT64_MAX};
+    uint64_t escala = escalas[i % 7];
+    return escala == 0 || escala == UINT64_MAX ? escala : (i * 2654435761u) % escala;
+}
+
+/* Cuántas de las primeras largo claves siguen vigentes en el momento t */
+static size_t vigentes_prueba(size_t largo, uint64_t inicio, uint64_t t)
+{
+    size_t vigentes = 0;
+    for (size_t i = 0; i < largo; i++) {
+        uint64_t ttl = ttl_prueba(i);
+        vigentes += ttl == UINT64_MAX || inicio + ttl > t;
+    }
+    return vigentes;
+}
+
+static void prueba_hash_ttl(hash_tipo_t tipo, size_t largo)
+{
+    hash_t* hash = hash_crear_con_tipo(free, tipo);
+    hash_ttl_reloj(hash, reloj_prueba);
+    const uint64_t inicio = 1000;
+    ahora_prueba = inicio;
+    print_test("Prueba hash ttl expirar sin vencimientos", hash_expirar(hash, inicio) == 0);
+
+    const size_t largo_clave = 32;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+    bool ok = true;
+    for (unsigned i = 0; i < largo; i++) {
+        sprintf(claves[i], "vence %08u", i);
+        size_t* dato = malloc(sizeof(size_t));
+        *dato = i;
+        if (ttl_prueba(i) == UINT64_MAX) {
+            ok &= hash_guardar(hash, claves[i], dato);
+        } else {
+            ok &= hash_guardar_con_ttl(hash, claves[i], dato, ttl_prueba(i));
+        }
+    }
+    hash_estadisticas_t estadisticas;
+    hash_estadisticas(hash, &estadisticas);
+    print_test("Prueba hash ttl guardar", ok && hash_cantidad(hash) == largo
+               && estadisticas.con_vencimiento == largo - largo / 7);
+
+    /* Las de ttl 0 vencen al guardarlas: ya no se ven, pero siguen ocupando lugar */
+    for (size_t i = 0; i < largo; i++) {
+        bool vigente = ttl_prueba(i) != 0;
+        ok &= hash_pertenece(hash, claves[i]) == vigente && (hash_obtener(hash, claves[i]) != NULL) == vigente;
+    }
+    print_test("Prueba hash ttl vencidas como ausentes", ok && hash_cantidad(hash) == largo);
+
+    /* Cada avance saca exactamente las vencidas, aunque sean muchas o el salto largo */
+    const uint64_t avances[] = {0, 1, 5, 63, 64, 900, 4096, 100000, 262144, 9000000, 1ULL << 36, 1ULL << 41};
+    uint64_t t = inicio;
+    for (size_t a = 0; a < sizeof(avances) / sizeof(avances[0]); a++) {
+        t += avances[a];
+        ahora_prueba = t;
+        size_t expirados;
+        do {
+            expirados = hash_expirar(hash, t);
+            ok &= expirados <= HASH_EXPIRAR_LOTE;
+        } while (expirados == HASH_EXPIRAR_LOTE);
+        ok &= hash_cantidad(hash) == vigentes_prueba(largo, inicio, t);
+    }
+    for (size_t i = 0; i < largo; i++) {
+        size_t* dato = hash_obtener(hash, claves[i]);
+        ok &= ttl_prueba(i) == UINT64_MAX ? dato && *dato == i : !dato;
+    }
+    print_test("Prueba hash ttl expirar", ok && hash_cantidad(hash) == largo / 7 + (largo % 7 == 7 - 1));
+
+    /* Guardar de nuevo cambia el vencimiento; hash_guardar lo quita */
+    for (size_t i = 0; i < 3; i++) {
+        ok &= hash_guardar_con_ttl(hash, claves[i], malloc(sizeof(size_t)), 100);
+    }
+    ok &= hash_guardar_con_ttl(hash, claves[0], malloc(sizeof(size_t)), 500);
+    ok &= hash_guardar(hash, claves[1], malloc(sizeof(size_t)));
+    ahora_prueba = t + 200;
+    ok &= hash_pertenece(hash, claves[0]) && hash_pertenece(hash, claves[1]) && !hash_pertenece(hash, claves[2]);
+    print_test("Prueba hash ttl reemplazar", ok);
+
+    /* Borrar una vencida devuelve NULL y destruye su dato; guardarla la revive */
+    ok &= hash_borrar(hash, claves[2]) == NULL && !hash_borrar(hash, claves[2]);
+    ok &= hash_guardar_con_ttl(hash, claves[3], malloc(sizeof(size_t)), 0);
+    bool insertado = false;
+    void** dato = hash_obtener_o_insertar(hash, claves[3], &insertado);
+    ok &= dato && insertado && *dato == NULL;
+    *dato = malloc(sizeof(size_t));
+    print_test("Prueba hash ttl borrar y revivir vencidas", ok && hash_pertenece(hash, claves[3]));
+
+    ahora_prueba = t + 1000;
+    ok &= hash_expirar(hash, ahora_prueba) == 1 && !hash_pertenece(hash, claves[0]);
+    hash_estadisticas(hash, &estadisticas);
+    print_test("Prueba hash ttl expirar lo reemplazado", ok && estadisticas.con_vencimiento == 0);
+
+    /* Las vigentes que quedan se liberan al destruir */
+    for (size_t i = 4; i < largo; i++) {
+        ok &= hash_guardar_con_ttl(hash, claves[i], malloc(sizeof(size_t)), i);
+    }
+    print_test("Prueba hash ttl destruir con vencimientos", ok);
+    hash_destruir(hash);
+
+    /* Un salto enorme del reloj no recorre uno por uno los giros de la rueda
+     * que hay hasta los vencimientos lejanos o infinitos */
+    hash = hash_crear_con_tipo(NULL, tipo);
+    hash_ttl_reloj(hash, reloj_prueba);
+    ahora_prueba = 0;
+    for (size_t i = 0; i < largo; i++) {
+        ok &= hash_guardar_con_ttl(hash, claves[i], NULL, i % 2 ? UINT64_MAX : (1ULL << 63) + i);
+    }
+    ahora_prueba = UINT64_MAX / 2;
+    ok &= hash_expirar(hash, ahora_prueba) == 0 && hash_cantidad(hash) == largo;
+    ahora_prueba = (1ULL << 63) + largo;
+    size_t expirados = 0;
+    for (size_t n; (n = hash_expirar(hash, ahora_prueba)) > 0; ) {
+        expirados += n;
+    }
+    ok &= expirados == largo / 2 && hash_cantidad(hash) == largo - largo / 2;
+    ahora_prueba = UINT64_MAX - 1;
+    ok &= hash_expirar(hash, ahora_prueba) == 0 && hash_pertenece(hash, claves[1]);
+    print_test("Prueba hash ttl saltos largos y ttl infinito", ok);
+    hash_destruir(hash);
+    free(claves);
+}
+
+/* El filtro no puede dar falsos negativos mientras se guarda, se borra y se
+ * rearma, y las claves ausentes casi nunca lo pasan */
+static void prueba_hash_filtro(hash_tipo_t tipo, size_t largo)
+{
+    hash_t* hash = hash_crear_con_tipo(NULL, tipo);
+    hash_estadisticas_t estadisticas;
+    print_test("Prueba hash filtro activar en vacio", hash_filtro_activar(hash, true));
+
+    const size_t largo_clave = 32;
+    char (*claves)[largo_clave] = malloc(2 * largo * largo_clave);
+    for (unsigned i = 0; i < 2 * largo; i++) {
+        sprintf(claves[i], "filtro %08u", i);
+    }
+    /* Guardar la primera mitad obliga a rearmar el filtro varias veces */
+    bool ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        ok &= hash_guardar(hash, claves[i], claves[i]);
+    }
+    for (size_t i = 0; i < largo; i++) {
+        ok &= hash_pertenece(hash, claves[i]) && hash_obtener(hash, claves[i]) == claves[i];
+    }
+    print_test("Prueba hash filtro sin falsos negativos", ok);
+
+    /* La segunda mitad no está */
+    for (size_t i = largo; i < 2 * largo; i++) {
+        ok &= !hash_pertenece(hash, claves[i]) && !hash_obtener(hash, claves[i]);
+    }
+    hash_estadisticas(hash, &estadisticas);
+    print_test("Prueba hash filtro descarta ausentes", ok && estadisticas.filtro_descartes > largo * 2 * 95 / 100);
+    print_test("Prueba hash filtro contadores",
+               estadisticas.filtro_consultas == 4 * largo
+               && estadisticas.filtro_descartes + estadisticas.filtro_falsos_positivos == 2 * largo);
+    print_test("Prueba hash filtro tasa", estadisticas.bytes_filtro > 0 && estadisticas.filtro_tasa_medida < 0.02
+               && estadisticas.filtro_tasa_estimada > 0 && estadisticas.filtro_tasa_estimada < 0.02);
+
+    /* Borrar más de la mitad rearma el filtro sin las borradas */
+    for (size_t i = 0; i < largo; i++) {
+        if (i % 4 != 0) {
+            ok &= hash_borrar(hash, claves[i]) == claves[i];
+        }
+    }
+    for (size_t i = 0; i < largo; i++) {
+        ok &= hash_pertenece(hash, claves[i]) == (i % 4 == 0);
+    }
+    print_test("Prueba hash filtro despues de borrar", ok);
+    for (size_t i = largo; i < 2 * largo; i++) {
+        ok &= hash_guardar(hash, claves[i], claves[i]);
+    }
+    for (size_t i = 0; i < 2 * largo; i++) {
+        ok &= hash_obtener(hash, claves[i]) == (i < largo && i % 4 != 0 ? NULL : claves[i]);
+    }
+    print_test("Prueba hash filtro guardar despues de borrar", ok);
+
+    /* Desactivado no cuenta nada y sigue encontrando todo */
+    print_test("Prueba hash filtro desactivar", hash_filtro_activar(hash, false));
+    for (size_t i = largo; i < 2 * largo; i++) {
+        ok &= hash_pertenece(hash, claves[i]);
+    }
+    hash_estadisticas(hash, &estadisticas);
+    print_test("Prueba hash filtro desactivado", ok && estadisticas.bytes_filtro == 0
+               && estadisticas.filtro_consultas == 0);
+
+    /* Activarlo con claves ya guardadas las incluye */
+    print_test("Prueba hash filtro activar con claves", hash_filtro_activar(hash, true));
+    for (size_t i = largo; i < 2 * largo; i++) {
+        ok &= hash_pertenece(hash, claves[i]);
+    }
+    print_test("Prueba hash filtro activado con claves", ok);
+
+    free(claves);
+    hash_destruir(hash);
+}
+
+HASH_DEFINIR(contador, uint64_t, size_t, hash_tipado_u64, hash_tipado_igual_u64)
+HASH_DEFINIR(indice, const char*, int, hash_tipado_cadena, hash_tipado_igual_cadena)
+
+static void prueba_hash_tipado(size_t largo)
+{
+    contador_t* contador = contador_crear();
+    print_test("Prueba hash tipado crear", contador && contador_cantidad(contador) == 0);
+    print_test("Prueba hash tipado obtener en vacio es NULL", !contador_obtener(contador, 1));
+
+    /* Cada clave i aparece i % 5 + 1 veces */
+    bool ok = true;
+    for (size_t vuelta = 0; vuelta < 5; vuelta++) {
+        for (uint64_t i = 0; i < largo; i++) {
+            if (i % 5 >= vuelta) {
+                bool insertado;
+                size_t* veces = contador_obtener_o_insertar(contador, i * 0x100000001ULL, &insertado);
+                ok &= veces != NULL && insertado == (vuelta == 0) && *veces == vuelta;
+                (*veces)++;
+            }
+        }
+    }
+    print_test("Prueba hash tipado obtener o insertar", ok && contador_cantidad(contador) == largo);
+    for (uint64_t i = 0; i < largo; i++) {
+        size_t* veces = contador_obtener(contador, i * 0x100000001ULL);
+        ok &= veces != NULL && *veces == i % 5 + 1;
+    }
+    print_test("Prueba hash tipado los contadores son correctos", ok);
+
+    /* Borra la mitad y vuelve a guardar, para reutilizar los borrados */
+    for (uint64_t i = 0; i < largo; i += 2) {
+        size_t veces = 0;
+        ok &= contador_borrar(contador, i * 0x100000001ULL, &veces) && veces == i % 5 + 1;
+    }
+    ok &= !contador_borrar(contador, 0, NULL) && contador_cantidad(contador) == largo / 2;
+    for (uint64_t i = 0; i < largo; i++) {
+        ok &= contador_pertenece(contador, i * 0x100000001ULL) == (i % 2 == 1);
+    }
+    print_test("Prueba hash tipado borrar", ok);
+    for (uint64_t i = 0; i < largo; i += 2) {
+        ok &= contador_guardar(contador, i * 0x100000001ULL, 7);
+    }
+    print_test("Prueba hash tipado guardar despues de borrar", ok && contador_cantidad(contador) == largo);
+
+    size_t recorridos = 0, suma = 0;
+    size_t pos = 0;
+    for (const contador_entrada_t* e; (e = contador_siguiente(contador, &pos));) {
+        recorridos++;
+        suma += e->valor;
+    }
+    size_t esperada = 0;
+    for (size_t i = 0; i < largo; i++) {
+        esperada += i % 2 == 0 ? 7 : i % 5 + 1;
+    }
+    print_test("Prueba hash tipado recorrer", recorridos == largo && suma == esperada);
+    contador_destruir(contador);
+
+    /* Claves cadena: el hash no las copia */
+    const char* nombres[] = {"cero", "uno", "dos", "tres", ""};
+    indice_t* indice = indice_crear();
+    for (int i = 0; i < 5; i++) {
+        indice_guardar(indice, nombres[i], i);
+    }
+    char buscada[] = "tres";
+    int* valor = indice_obtener(indice, buscada);
+    print_test("Prueba hash tipado claves cadena", valor && *valor == 3 && indice_pertenece(indice, "")
+               && !indice_pertenece(indice, "cuatro") && indice_cantidad(indice) == 5);
+    indice_destruir(indice);
+}
+
+static void prueba_hash_u64(size_t largo)
+{
+    hash_u64_t* hash = hash_u64_crear(free);
+    print_test("Prueba hash u64 crear", hash && hash_u64_cantidad(hash) == 0);
+    print_test("Prueba hash u64 obtener en vacio es NULL", !hash_u64_obtener(hash, 0));
+    print_test("Prueba hash u64 borrar en vacio es NULL", !hash_u64_borrar(hash, 0));
+
+    /* Claves espaciadas para que no sean consecutivas, incluido el 0 */
+    bool ok = true;
+    for (uint64_t i = 0; i < largo; i++) {
+        size_t* dato = malloc(sizeof(size_t));
+        *dato = i;
+        ok &= hash_u64_guardar(hash, i << 20, dato);
+    }
+    print_test("Prueba hash u64 guardar muchos", ok && hash_u64_cantidad(hash) == largo);
+    for (uint64_t i = 0; i < largo; i++) {
+        size_t* dato = hash_u64_obtener(hash, i << 20);
+        ok &= dato && *dato == i && hash_u64_pertenece(hash, i << 20) && !hash_u64_pertenece(hash, (i << 20) + 1);
+    }
+    print_test("Prueba hash u64 obtener y pertenece", ok);
+
+    /* Reemplazar destruye el dato anterior */
+    size_t* nuevo = malloc(sizeof(size_t));
+    *nuevo = largo;
+    ok = hash_u64_guardar(hash, 0, nuevo) && hash_u64_obtener(hash, 0) == nuevo;
+    print_test("Prueba hash u64 reemplazar", ok && hash_u64_cantidad(hash) == largo);
+
+    for (uint64_t i = 1; i < largo; i += 2) {
+        size_t* dato = hash_u64_borrar(hash, i << 20);
+        ok &= dato && *dato == i;
+        free(dato);
+    }
+    print_test("Prueba hash u64 borrar la mitad", ok && hash_u64_cantidad(hash) == (largo + 1) / 2);
+
+    size_t recorridos = 0;
+    hash_u64_iter_t* iter = hash_u64_iter_crear(hash);
+    for (; !hash_u64_iter_al_final(iter); hash_u64_iter_avanzar(iter)) {
+        uint64_t clave = hash_u64_iter_ver_actual(iter);
+        size_t* dato = hash_u64_iter_ver_dato(iter);
+        ok &= clave % (2 << 20) == 0 && (clave == 0 ? dato == nuevo : *dato == clave >> 20);
+        recorridos++;
+    }
+    print_test("Prueba hash u64 iterar", ok && recorridos == hash_u64_cantidad(hash));
+    print_test("Prueba hash u64 iterador al final", !hash_u64_iter_avanzar(iter) && !hash_u64_iter_ver_dato(iter));
+    hash_u64_iter_destruir(iter);
+
+    /* destruir libera los datos que quedan */
+    hash_u64_destruir(hash);
+}
+
+static void prueba_hash_claves_binarias(hash_tipo_t tipo, size_t largo)
+{
+    hash_t* hash = hash_crear_con_tipo(NULL, tipo);
+
+    /* Claves que sólo difieren después de un '\0' */
+    char *valor1 = "a", *valor2 = "b", *valor3 = "c";
+    print_test("Prueba hash binario guardar \"x\\0a\"", hash_guardar_n(hash, "x\0a", 3, valor1));
+    print_test("Prueba hash binario guardar \"x\\0b\"", hash_guardar_n(hash, "x\0b", 3, valor2));
+    print_test("Prueba hash binario guardar \"x\"", hash_guardar(hash, "x", valor3));
+    print_test("Prueba hash binario obtener \"x\\0a\"", hash_obtener_n(hash, "x\0a", 3) == valor1);
+    print_test("Prueba hash binario obtener \"x\\0b\"", hash_obtener_n(hash, "x\0b", 3) == valor2);
+    print_test("Prueba hash binario \"x\" con largo 1", hash_obtener_n(hash, "x\0b", 1) == valor3);
+    print_test("Prueba hash binario \"x\\0\" no pertenece", !hash_pertenece_n(hash, "x\0", 2));
+    print_test("Prueba hash binario borrar \"x\\0a\"", hash_borrar_n(hash, "x\0a", 3) == valor1);
+    print_test("Prueba hash binario \"x\\0b\" sigue", hash_pertenece_n(hash, "x\0b", 3));
+    hash_borrar_n(hash, "x\0b", 3);
+    hash_borrar(hash, "x");
+
+    /* Enteros de 8 bytes como claves, con muchos bytes en cero */
+    uint64_t* claves = malloc(largo * sizeof(uint64_t));
+    bool ok = true;
+    for (size_t i = 0; i < largo && ok; i++) {
+        claves[i] = i << 20;
+        ok = hash_guardar_n(hash, &claves[i], sizeof(uint64_t), &claves[i]);
+    }
+    print_test("Prueba hash binario almacenar enteros", ok);
+    for (size_t i = 0; i < largo && ok; i++) {
+        uint64_t clave = i << 20;
+        ok = hash_obtener_n(hash, &clave, sizeof(clave)) == &claves[i];
+    }
+    print_test("Prueba hash binario obtener enteros", ok);
+
+    hash_iter_t* iter = hash_iter_crear(hash);
+    size_t recorridos = 0;
+    for (; !hash_iter_al_final(iter) && ok; hash_iter_avanzar(iter)) {
+        uint64_t clave;
+        ok = hash_iter_ver_largo(iter) == sizeof(clave);
+        memcpy(&clave, hash_iter_ver_actual(iter), sizeof(clave));
+        ok = ok && hash_obtener_n(hash, &clave, sizeof(clave)) == &claves[clave >> 20];
+        recorridos++;
+    }
+    hash_iter_destruir(iter);
+    print_test("Prueba hash binario iterar enteros", ok && recorridos == largo);
+
+    free(claves);
+    hash_destruir(hash);
+}
+
+/* Cuenta apariciones guardando el contador en el propio puntero */
+static void* contar(void* dato, bool existia, void* extra)
+{
+    bool* ok = extra;
+    if (!existia && dato != NULL) *ok = false;
+    return (void*) ((uintptr_t) dato + 1);
+}
+
+static void prueba_hash_obtener_o_insertar(hash_tipo_t tipo, size_t largo)
+{
+    hash_t* hash = hash_crear_con_tipo(NULL, tipo);
+    hash_redimension_incremental(hash, true);
+
+    const size_t largo_clave = 10;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+    size_t* contadores = calloc(largo, sizeof(size_t));
+    for (unsigned i = 0; i < largo; i++) {
+        sprintf(claves[i], "%08d", i);
+    }
+
+    /* Cada clave aparece tres veces */
+    bool ok = true;
+    size_t insertados = 0;
+    for (size_t i = 0; i < 3 * largo && ok; i++) {
+        bool insertado;
+        void** dato = hash_obtener_o_insertar(hash, claves[i % largo], &insertado);
+        ok = dato != NULL && insertado == (i < largo) && (!insertado || *dato == NULL);
+        if (!ok) break;
+        if (insertado) {
+            *dato = &contadores[i % largo];
+            insertados++;
+        }
+        (*(size_t*) *dato)++;
+    }
+    print_test("Prueba hash obtener o insertar una vez por clave", ok && insertados == largo);
+    for (size_t i = 0; i < largo && ok; i++) {
+        ok = contadores[i] == 3 && hash_obtener(hash, claves[i]) == &contadores[i];
+    }
+    print_test("Prueba hash obtener o insertar cuenta todas las apariciones", ok);
+    print_test("Prueba hash obtener o insertar la cantidad es correcta", hash_cantidad(hash) == largo);
+    hash_destruir(hash);
+
+    hash = hash_crear_con_tipo(NULL, tipo);
+    for (size_t i = 0; i < 3 * largo && ok; i++) {
+        ok = hash_actualizar(hash, claves[i % largo], contar, &ok);
+    }
+    print_test("Prueba hash actualizar contar apariciones", ok);
+    for (size_t i = 0; i < largo && ok; i++) {
+        void* contador = hash_obtener(hash, claves[i]);
+        ok = (uintptr_t) contador == 3;
+    }
+    print_test("Prueba hash actualizar los contadores son correctos", ok);
+    print_test("Prueba hash actualizar la cantidad es correcta", hash_cantidad(hash) == largo);
+
+    free(claves);
+    free(contadores);
+    hash_destruir(hash);
+}
+
+static void prueba_hash_lotes(hash_tipo_t tipo, size_t largo)
+{
+    hash_t* hash = hash_crear_con_tipo(NULL, tipo);
+
+    /* La segunda mitad repite las claves de la primera con otros datos */
+    const size_t largo_clave = 10;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+    const char** punteros = malloc(2 * largo * sizeof(char*));
+    size_t* valores = malloc(2 * largo * sizeof(size_t));
+    void** datos = malloc(2 * largo * sizeof(void*));
+    for (unsigned i = 0; i < largo; i++) {
+        sprintf(claves[i], "%08d", i);
+    }
+    for (size_t i = 0; i < 2 * largo; i++) {
+        punteros[i] = claves[i % (largo / 2)];
+        valores[i] = i;
+        datos[i] = &valores[i];
+    }
+
+    print_test("Prueba hash lote guardar", hash_guardar_lote(hash, punteros, datos, largo));
+    print_test("Prueba hash lote la cantidad es correcta", hash_cantidad(hash) == largo / 2);
+
+    /* Busca todas las claves: las de la segunda mitad no están */
+    for (size_t i = 0; i < largo; i++) {
+        punteros[i] = claves[i];
+    }
+    hash_obtener_lote(hash, punteros, largo, datos);
+    bool ok = true;
+    for (size_t i = 0; i < largo && ok; i++) {
+        ok = datos[i] == (i < largo / 2 ? &valores[i + largo / 2] : NULL);
+    }
+    print_test("Prueba hash lote obtener gana el ultimo repetido", ok);
+    for (size_t i = 0; i < largo && ok; i++) {
+        ok = hash_obtener(hash, claves[i]) == datos[i];
+    }
+    print_test("Prueba hash lote obtener coincide con hash_obtener", ok);
+
+    free(claves);
+    free(punteros);
+    free(valores);
+    free(datos);
+    hash_destruir(hash);
+}
+
+typedef struct hilo_prueba {
+    hash_concurrente_t* hash;
+    size_t numero;
+    size_t largo;
+    bool ok;
+} hilo_prueba_t;
+
+/* Cada hilo guarda sus propias claves, las verifica y borra la mitad */
+static void* hilo_guardar_y_borrar(void* extra)
+{
+    hilo_prueba_t* hilo = extra;
+    char clave[48];
+    hilo->ok = true;
+    for (size_t i = 0; i < hilo->largo && hilo->ok; i++) {
+        sprintf(clave, "%02zu-%08zu", hilo->numero, i);
+        hilo->ok = hash_concurrente_guardar(hilo->hash, clave, hilo);
+    }
+    for (size_t i = 0; i < hilo->largo && hilo->ok; i++) {
+        sprintf(clave, "%02zu-%08zu", hilo->numero, i);
+        hilo->ok = hash_concurrente_obtener(hilo->hash, clave) == hilo;
+    }
+    for (size_t i = 0; i < hilo->largo && hilo->ok; i += 2) {
+        sprintf(clave, "%02zu-%08zu", hilo->numero, i);
+        hilo->ok = hash_concurrente_borrar(hilo->hash, clave) == hilo;
+    }
+    return NULL;
+}
+
+static void prueba_hash_concurrente(hash_concurrente_modo_t modo, hash_tipo_t tipo, size_t cantidad_hilos, size_t largo)
+{
+    hash_concurrente_t* hash = hash_concurrente_crear_con_modo(NULL, tipo, 0, modo);
+    print_test("Prueba hash concurrente crear", hash != NULL);
+    print_test("Prueba hash concurrente guardar", hash_concurrente_guardar(hash, "clave", "valor"));
+    print_test("Prueba hash concurrente pertenece", hash_concurrente_pertenece(hash, "clave"));
+    print_test("Prueba hash concurrente borrar", strcmp(hash_concurrente_borrar(hash, "clave"), "valor") == 0);
+    print_test("Prueba hash concurrente no pertenece", !hash_concurrente_pertenece(hash, "clave"));
+
+    pthread_t* hilos = malloc(cantidad_hilos * sizeof(pthread_t));
+    hilo_prueba_t* datos = malloc(cantidad_hilos * sizeof(hilo_prueba_t));
+    for (size_t i = 0; i < cantidad_hilos; i++) {
+        datos[i] = (hilo_prueba_t) {hash, i, largo, false};
+        pthread_create(&hilos[i], NULL, hilo_guardar_y_borrar, &datos[i]);
+    }
+    bool ok = true;
+    for (size_t i = 0; i < cantidad_hilos; i++) {
+        pthread_join(hilos[i], NULL);
+        ok = ok && datos[i].ok;
+    }
+    print_test("Prueba hash concurrente varios hilos guardan, obtienen y borran", ok);
+    print_test("Prueba hash concurrente la cantidad es correcta",
+               hash_concurrente_cantidad(hash) == cantidad_hilos * (largo / 2));
+
+    char clave[48];
+    for (size_t i = 0; i < cantidad_hilos && ok; i++) {
+        for (size_t j = 0; j < largo && ok; j++) {
+            sprintf(clave, "%02zu-%08zu", i, j);
+            ok = hash_concurrente_obtener(hash, clave) == (j % 2 == 1 ? &datos[i] : NULL);
+        }
+    }
+    print_test("Prueba hash concurrente quedan las claves esperadas", ok);
+
+    free(hilos);
+    free(datos);
+    hash_concurrente_destruir(hash);
+}
+
+typedef struct lector_prueba {
+    hash_concurrente_t* hash;
+    size_t largo;
+    atomic_bool* terminar;
+    bool ok;
+} lector_prueba_t;
+
+/* Lee claves fijas mientras otro hilo reemplaza sus datos. Cada dato se usa
+ * dentro de la época, así que no puede haberse liberado todavía */
+static void* hilo_leer(void* extra)
+{
+    lector_prueba_t* lector = extra;
+    char clave[48];
+    lector->ok = true;
+    while (lector->ok && !atomic_load(lector->terminar)) {
+        for (size_t i = 0; i < lector->largo && lector->ok; i++) {
+            sprintf(clave, "fija-%08zu", i);
+            epoca_entrar();
+            size_t* dato = hash_concurrente_obtener(lector->hash, clave);
+            lector->ok = dato != NULL && *dato == i;
+            epoca_salir();
+        }
+    }
+    return NULL;
+}
+
+static size_t* numero_crear(size_t numero)
+{
+    size_t* dato = malloc(sizeof(size_t));
+    *dato = numero;
+    return dato;
+}
+
+static void prueba_hash_lecturas_libres(size_t cantidad_lectores, size_t largo, size_t rondas)
+{
+    hash_concurrente_t* hash = hash_concurrente_crear_con_modo(free, HASH_ABIERTO, 4, HASH_CONCURRENTE_LECTURAS_LIBRES);
+    print_test("Prueba hash lecturas libres crear", hash != NULL);
+
+    char clave[48];
+    bool ok = true;
+    for (size_t i = 0; i < largo && ok; i++) {
+        sprintf(clave, "fija-%08zu", i);
+        ok = hash_concurrente_guardar(hash, clave, numero_crear(i));
+    }
+    print_test("Prueba hash lecturas libres guardar claves fijas", ok);
+
+    atomic_bool terminar;
+    atomic_init(&terminar, false);
+    pthread_t* hilos = malloc(cantidad_lectores * sizeof(pthread_t));
+    lector_prueba_t* lectores = malloc(cantidad_lectores * sizeof(lector_prueba_t));
+    for (size_t i = 0; i < cantidad_lectores; i++) {
+        lectores[i] = (lector_prueba_t) {hash, largo, &terminar, false};
+        pthread_create(&hilos[i], NULL, hilo_leer, &lectores[i]);
+    }
+
+    /* Reemplaza los datos de las claves fijas y hace crecer la tabla con
+     * claves temporales, que después borra */
+    for (size_t r = 0; r < rondas && ok; r++) {
+        for (size_t i = 0; i < largo && ok; i++) {
+            sprintf(clave, "fija-%08zu", i);
+            ok = hash_concurrente_guardar(hash, clave, numero_crear(i));
+            sprintf(clave, "temp-%02zu-%08zu", r, i);
+            ok = ok && hash_concurrente_guardar(hash, clave, numero_crear(i));
+        }
+        for (size_t i = 0; i < largo && ok; i++) {
+            sprintf(clave, "temp-%02zu-%08zu", r, i);
+            size_t* dato = hash_concurrente_borrar(hash, clave);
+            ok = dato != NULL && *dato == i;
+            free(dato);
+        }
+    }
+    print_test("Prueba hash lecturas libres escribir mientras se lee", ok);
+
+    atomic_store(&terminar, true);
+    for (size_t i = 0; i < cantidad_lectores; i++) {
+        pthread_join(hilos[i], NULL);
+        ok = ok && lectores[i].ok;
+    }
+    print_test("Prueba hash lecturas libres los lectores ven siempre un dato válido", ok);
+    print_test("Prueba hash lecturas libres la cantidad es correcta", hash_concurrente_cantidad(hash) == largo);
+
+    free(hilos);
+    free(lectores);
+    /* Libera los datos reemplazados pendientes y los actuales */
+    hash_concurrente_destruir(hash);
+}
+
+static void prueba_hash_construir(hash_tipo_t tipo, size_t largo, size_t hilos)
+{
+    /* Las claves se repiten cada 'distintas', con datos pedidos con malloc
+     * para que los reemplazados tengan que destruirse */
+    size_t distintas = largo * 7 / 8;
+    const size_t largo_clave = 10;
+    char (*claves)[largo_clave] = malloc(distintas * largo_clave);
+    const char** punteros = malloc(largo * sizeof(char*));
+    void** datos = malloc(largo * sizeof(void*));
+    for (unsigned i = 0; i < distintas; i++) {
+        sprintf(claves[i], "%08u", i);
+    }
+    for (size_t i = 0; i < largo; i++) {
+        punteros[i] = claves[i % distintas];
+        datos[i] = numero_crear(i);
+    }
+
+    hash_t* hash = hash_construir(free, tipo, punteros, datos, largo, hilos);
+    print_test("Prueba hash construir", hash != NULL);
+    print_test("Prueba hash construir la cantidad es correcta", hash_cantidad(hash) == distintas);
+
+    bool ok = true;
+    for (size_t i = 0; i < distintas && ok; i++) {
+        size_t* dato = hash_obtener(hash, claves[i]);
+        ok = dato != NULL && *dato == (i + distintas < largo ? i + distintas : i);
+    }
+    print_test("Prueba hash construir gana el ultimo repetido", ok);
+
+    /* El resultado es un hash común */
+    ok = true;
+    for (size_t i = 0; i < distintas && ok; i += 2) {
+        free(hash_borrar(hash, claves[i]));
+        ok = !hash_pertenece(hash, claves[i]);
+    }
+    print_test("Prueba hash construir borrar", ok);
+    print_test("Prueba hash construir guardar", hash_guardar(hash, "nueva", numero_crear(0)));
+    size_t iterados = 0;
+    hash_iter_t* iter = hash_iter_crear(hash);
+    for (; !hash_iter_al_final(iter); hash_iter_avanzar(iter)) {
+        iterados++;
+    }
+    hash_iter_destruir(iter);
+    print_test("Prueba hash construir iterar", iterados == hash_cantidad(hash) && iterados == distintas / 2 + 1);
+
+    hash_t* vacio = hash_construir(NULL, tipo, punteros, datos, 0, hilos);
+    print_test("Prueba hash construir vacio", vacio != NULL && hash_cantidad(vacio) == 0);
+
+    free(claves);
+    free(punteros);
+    free(datos);
+    hash_destruir(hash);
+    hash_destruir(vacio);
+}
+
+typedef struct recuento {
+    _Atomic size_t cantidad;
+    _Atomic size_t suma;
+    _Atomic bool ok;
+    size_t tope;
+} recuento_t;
+
+/* Cuenta los pares y suma sus datos, verificando que el dato sea el número
+ * de la clave. Corta al llegar al tope */
+static bool contar_par(const char* clave, void* dato, void* extra)
+{
+    recuento_t* recuento = extra;
+    size_t numero = (size_t) strtoul(clave, NULL, 10);
+    if (*(size_t*) dato != numero) {
+        atomic_store(&recuento->ok, false);
+    }
+    atomic_fetch_add(&recuento->suma, numero);
+    return atomic_fetch_add(&recuento->cantidad, 1) + 1 < recuento->tope;
+}
+
+static void prueba_hash_iterar_interno(hash_tipo_t tipo, size_t largo)
+{
+    hash_t* hash = hash_crear_con_tipo(NULL, tipo);
+    hash_redimension_incremental(hash, true);
+
+    const size_t largo_clave = 10;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+    size_t* valores = malloc(largo * sizeof(size_t));
+    for (unsigned i = 0; i < largo; i++) {
+        sprintf(claves[i], "%08u", i);
+        valores[i] = i;
+        hash_guardar(hash, claves[i], &valores[i]);
+    }
+
+    recuento_t recuento = {0, 0, true, largo};
+    hash_iterar(hash, contar_par, &recuento);
+    print_test("Prueba hash iterar interno visita todos los pares", recuento.cantidad == largo && recuento.ok);
+    print_test("Prueba hash iterar interno la suma es correcta", recuento.suma == largo * (largo - 1) / 2);
+
+    recuento = (recuento_t) {0, 0, true, 10};
+    hash_iterar(hash, contar_par, &recuento);
+    print_test("Prueba hash iterar interno corta cuando visitar devuelve false", recuento.cantidad == 10);
+
+    recuento = (recuento_t) {0, 0, true, largo};
+    hash_iterar_paralelo(hash, contar_par, &recuento, 4);
+    print_test("Prueba hash iterar paralelo visita todos los pares", recuento.cantidad == largo && recuento.ok);
+    print_test("Prueba hash iterar paralelo la suma es correcta", recuento.suma == largo * (largo - 1) / 2);
+
+    recuento = (recuento_t) {0, 0, true, 10};
+    hash_iterar_paralelo(hash, contar_par, &recuento, 4);
+    print_test("Prueba hash iterar paralelo corta cuando visitar devuelve false", recuento.cantidad < largo);
+
+    free(claves);
+    free(valores);
+    hash_destruir(hash);
+}
+
+/* Recorre con un iterador en la pila y verifica que cada dato sea el
+ * número de su clave. Devuelve la cantidad de pares recorridos, o largo + 1
+ * si algún dato no coincide */
+static size_t recorrer_en_pila(const hash_t* hash, size_t largo)
+{
+    hash_iter_t iter;
+    size_t recorridos = 0;
+    for (hash_iter_iniciar(&iter, hash); !hash_iter_al_final(&iter); hash_iter_avanzar(&iter)) {
+        size_t* dato = hash_iter_ver_dato(&iter);
+        if (dato == NULL || *dato != (size_t) strtoul(hash_iter_ver_actual(&iter), NULL, 10)) {
+            recorridos = largo;
+        }
+        recorridos++;
+    }
+    hash_iter_finalizar(&iter);
+    return recorridos;
+}
+
+static void prueba_hash_iterar_pila(hash_tipo_t tipo, size_t largo)
+{
+    hash_t* hash = hash_crear_con_tipo(NULL, tipo);
+    hash_redimension_incremental(hash, true);
+
+    hash_iter_t iter;
+    hash_iter_iniciar(&iter, hash);
+    print_test("Prueba hash iterador en pila vacio esta al final", hash_iter_al_final(&iter));
+    print_test("Prueba hash iterador en pila vacio ver dato es NULL", hash_iter_ver_dato(&iter) == NULL);
+    hash_iter_finalizar(&iter);
+
+    const size_t largo_clave = 10;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+    size_t* valores = malloc(largo * sizeof(size_t));
+    for (unsigned i = 0; i < largo; i++) {
+        sprintf(claves[i], "%08u", i);
+        valores[i] = i;
+        hash_guardar(hash, claves[i], &valores[i]);
+    }
+    /* Con la redimensión incremental en curso recorre las dos tablas */
+    print_test("Prueba hash iterador en pila recorre todo", recorrer_en_pila(hash, largo) == largo);
+
+    /* Deja la tabla casi vacía para que haya que saltear regiones sin pares */
+    for (size_t i = 0; i < largo; i++) {
+        if (i % 97 != 0) {
+            hash_borrar(hash, claves[i]);
+        }
+    }
+    print_test("Prueba hash iterador en pila con tabla dispersa",
+               recorrer_en_pila(hash, largo) == hash_cantidad(hash) && hash_cantidad(hash) == (largo + 96) / 97);
+
+    free(claves);
+    free(valores);
+    hash_destruir(hash);
+}
+
+/* Número guardado en el propio puntero */
+static size_t como_numero(const void* dato)
+{
+    return (size_t) (uintptr_t) dato;
+}
+
+/* Verifica que el dato de cada par sea el número de su clave, guardado en
+ * el propio puntero */
+static bool contar_par_numerico(const char* clave, void* dato, void* extra)
+{
+    size_t* cantidad = extra;
+    if (como_numero(dato) == (size_t) strtoul(clave, NULL, 10)) {
+        (*cantidad)++;
+    }
+    return true;
+}
+
+static void prueba_hash_volcado(hash_tipo_t tipo, size_t largo)
+{
+    const char* ruta = "prueba_hash.img";
+    const char* ruta_copia = "prueba_hash_copia.img";
+    hash_t* hash = hash_crear_con_tipo(NULL, tipo);
+
+    /* Los datos son los números de las claves, que no dependen de la memoria */
+    const size_t largo_clave = 10;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+    for (unsigned i = 0; i < largo; i++) {
+        sprintf(claves[i], "%08u", i);
+        hash_guardar(hash, claves[i], (void*) (uintptr_t) i);
+    }
+    for (size_t i = 0; i < largo; i += 3) {
+        hash_borrar(hash, claves[i]);
+    }
+    const char binaria[] = {'a', '\0', 'b'};
+    hash_guardar_n(hash, binaria, sizeof(binaria), (void*) (uintptr_t) 7);
+    size_t cantidad = hash_cantidad(hash);
+
+    print_test("Prueba hash volcar", hash_volcar(hash, ruta));
+    hash_destruir(hash);
+
+    hash_t* mapeado = hash_abrir_mmap(ruta);
+    print_test("Prueba hash abrir imagen", mapeado);
+    print_test("Prueba hash imagen la cantidad es correcta", hash_cantidad(mapeado) == cantidad);
+
+    bool ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        bool borrada = i % 3 == 0;
+        ok &= hash_pertenece(mapeado, claves[i]) != borrada;
+        ok &= como_numero(hash_obtener(mapeado, claves[i])) == (borrada ? 0 : i);
+    }
+    print_test("Prueba hash imagen obtener y pertenece son correctos", ok);
+    print_test("Prueba hash imagen clave binaria",
+               como_numero(hash_obtener_n(mapeado, binaria, sizeof(binaria))) == 7 && !hash_pertenece_n(mapeado, binaria, 2));
+    print_test("Prueba hash imagen clave inexistente", !hash_pertenece(mapeado, "no esta"));
+
+    size_t recorridos = 0;
+    hash_iter_t iter;
+    for (hash_iter_iniciar(&iter, mapeado); !hash_iter_al_final(&iter); hash_iter_avanzar(&iter)) {
+        const char* clave = hash_iter_ver_actual(&iter);
+        if (hash_iter_ver_largo(&iter) == strlen(clave)
+            && como_numero(hash_iter_ver_dato(&iter)) == (size_t) strtoul(clave, NULL, 10)) {
+            recorridos++;
+        }
+    }
+    hash_iter_finalizar(&iter);
+    /* La clave binaria es la única que no cumple */
+    print_test("Prueba hash imagen iterador recorre todo", recorridos == cantidad - 1);
+    recorridos = 0;
+    hash_iterar(mapeado, contar_par_numerico, &recorridos);
+    print_test("Prueba hash imagen iterar interno recorre todo", recorridos == cantidad - 1);
+
+    print_test("Prueba hash imagen no se puede guardar", !hash_guardar(mapeado, "nueva", NULL));
+    const char* nuevas[] = {"a", "b"};
+    void* const datos_nuevos[] = {NULL, NULL};
+    print_test("Prueba hash imagen no se puede guardar en lote",
+               !hash_guardar_lote(mapeado, nuevas, datos_nuevos, 2) && hash_cantidad(mapeado) == cantidad);
+    print_test("Prueba hash imagen no se puede borrar", !hash_borrar(mapeado, claves[1]) && hash_pertenece(mapeado, claves[1]));
+
+    /* Una imagen mapeada se puede volver a volcar */
+    print_test("Prueba hash volcar imagen", hash_volcar(mapeado, ruta_copia));
+    hash_destruir(mapeado);
+    mapeado = hash_abrir_mmap(ruta_copia);
+    print_test("Prueba hash abrir copia de imagen",
+               mapeado && hash_cantidad(mapeado) == cantidad && como_numero(hash_obtener(mapeado, claves[2])) == 2);
+    hash_destruir(mapeado);
+
+    /* Un archivo que no es una imagen */
+    FILE* archivo = fopen(ruta, "w");
+    fputs("esto no es una imagen de un hash, aunque sea lo bastante largo", archivo);
+    fclose(archivo);
+    print_test("Prueba hash abrir archivo invalido devuelve NULL", !hash_abrir_mmap(ruta));
+    print_test("Prueba hash abrir archivo inexistente devuelve NULL", !hash_abrir_mmap("no_existe.img"));
+
+    remove(ruta);
+    remove(ruta_copia);
+    free(claves);
+}
+
 /* ******************************************************************
  *                        FUNCIÓN PRINCIPAL
  * *****************************************************************/
@@ -411,6 +1841,50 @@ void pruebas_hash_catedra()
     prueba_hash_volumen(5000, true);
     prueba_hash_iterar();
     prueba_hash_iterar_volumen(5000);
+    prueba_hash_cerrado_volumen(5000);
+    /* Largos elegidos para que la última redimensión siga en curso al iterar */
+    prueba_hash_incremental(HASH_ABIERTO, 4100);
+    prueba_hash_incremental(HASH_CERRADO, 2870);
+    prueba_hash_rotacion_claves(HASH_ABIERTO, 200000);
+    prueba_hash_rotacion_claves(HASH_CERRADO, 200000);
+    prueba_hash_funcion(HASH_ABIERTO, hash_funcion_djb2, 5000);
+    prueba_hash_funcion(HASH_CERRADO, hash_funcion_djb2, 5000);
+    prueba_hash_funcion(HASH_ABIERTO, hash_constante, 500);
+    prueba_hash_funcion(HASH_CERRADO, hash_constante, 500);
+    prueba_hash_con_hash(HASH_ABIERTO, 5000);
+    prueba_hash_con_hash(HASH_CERRADO, 5000);
+    prueba_hash_claves_binarias(HASH_ABIERTO, 5000);
+    prueba_hash_claves_binarias(HASH_CERRADO, 5000);
+    prueba_hash_obtener_o_insertar(HASH_ABIERTO, 5000);
+    prueba_hash_obtener_o_insertar(HASH_CERRADO, 5000);
+    prueba_hash_lotes(HASH_ABIERTO, 5000);
+    prueba_hash_lotes(HASH_CERRADO, 5000);
+    prueba_hash_concurrente(HASH_CONCURRENTE_LOCKS, HASH_ABIERTO, 8, 5000);
+    prueba_hash_concurrente(HASH_CONCURRENTE_LOCKS, HASH_CERRADO, 8, 5000);
+    prueba_hash_concurrente(HASH_CONCURRENTE_LECTURAS_LIBRES, HASH_ABIERTO, 8, 5000);
+    prueba_hash_lecturas_libres(4, 2000, 5);
+    prueba_hash_construir(HASH_ABIERTO, 50000, 4);
+    prueba_hash_construir(HASH_CERRADO, 50000, 4);
+    prueba_hash_construir(HASH_CERRADO, 1000, 0);
+    prueba_hash_iterar_interno(HASH_ABIERTO, 4100);
+    prueba_hash_iterar_interno(HASH_CERRADO, 2870);
+    prueba_hash_iterar_pila(HASH_ABIERTO, 4100);
+    prueba_hash_iterar_pila(HASH_CERRADO, 2870);
+    prueba_hash_volcado(HASH_ABIERTO, 5000);
+    prueba_hash_volcado(HASH_CERRADO, 5000);
+    prueba_hash_estadisticas(HASH_ABIERTO, 5000);
+    prueba_hash_estadisticas(HASH_CERRADO, 5000);
+    prueba_hash_claves_largos(HASH_ABIERTO, 20000);
+    prueba_hash_claves_largos(HASH_CERRADO, 20000);
+    prueba_hash_filtro(HASH_ABIERTO, 20000);
+    prueba_hash_filtro(HASH_CERRADO, 20000);
+    prueba_hash_capacidad(HASH_ABIERTO, 20000);
+    prueba_hash_capacidad(HASH_CERRADO, 20000);
+    prueba_hash_cache(50000);
+    prueba_hash_ttl(HASH_ABIERTO, 20000);
+    prueba_hash_ttl(HASH_CERRADO, 20000);
+    prueba_hash_tipado(50000);
+    prueba_hash_u64(50000);
 }
 
 void pruebas_volumen_catedra(size_t largo)
@@ -0,0 +1,283 @@
+#ifndef HASH_TIPADO_H
+#define HASH_TIPADO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "wyhash.h"
+
+/* HASH_DEFINIR(nombre, tipo_clave, tipo_valor, fn_hash, fn_igual) define un
+ * hash cuyas claves y valores se guardan por valor dentro de la tabla, sin
+ * void* ni memoria aparte para cada par. Por ejemplo, para contar
+ * apariciones de enteros:
+ *
+ *     HASH_DEFINIR(contador, uint64_t, size_t, hash_tipado_u64, hash_tipado_igual_u64)
+ *
+ *     contador_t *contador = contador_crear();
+ *     size_t *veces = contador_obtener_o_insertar(contador, 42, NULL);
+ *     (*veces)++;
+ *
+ * fn_hash(clave) devuelve un uint64_t, del que se usan tanto los bits bajos
+ * como los altos, y fn_igual(a, b) un bool. Todo se define static inline en
+ * el lugar donde se usa la macro, así que el compilador puede meter las dos
+ * funciones dentro del sondeo. La tabla es de direccionamiento abierto con
+ * sondeo lineal y un byte de control por posición, como HASH_CERRADO, y el
+ * hash de cada clave se vuelve a calcular al redimensionar.
+ *
+ * Claves y valores se copian con '=': si tienen punteros, lo apuntado no se
+ * copia ni se libera. Los punteros a valores que devuelven las primitivas
+ * valen hasta la próxima modificación del hash. A diferencia de hash_t no
+ * hay semilla aleatoria: si las claves vienen de afuera, fn_hash tiene que
+ * resistir colisiones elegidas a propósito.
+ *
+ * Define el tipo nombre_t, el tipo nombre_entrada_t {clave, valor} y:
+ *
+ *     nombre_t *nombre_crear(void);
+ *     void nombre_destruir(nombre_t *hash);
+ *     bool nombre_guardar(nombre_t *hash, tipo_clave clave, tipo_valor valor);
+ *     tipo_valor *nombre_obtener(const nombre_t *hash, tipo_clave clave);
+ *     bool nombre_pertenece(const nombre_t *hash, tipo_clave clave);
+ *     tipo_valor *nombre_obtener_o_insertar(nombre_t *hash, tipo_clave clave, bool *insertado);
+ *     bool nombre_borrar(nombre_t *hash, tipo_clave clave, tipo_valor *valor);
+ *     size_t nombre_cantidad(const nombre_t *hash);
+ *     const nombre_entrada_t *nombre_siguiente(const nombre_t *hash, size_t *pos);
+ *
+ * Se comportan como sus equivalentes de hash.h, salvo que: nombre_obtener
+ * devuelve la dirección del valor, o NULL si la clave no está;
+ * nombre_obtener_o_insertar inicializa en cero el valor de una clave nueva;
+ * nombre_borrar devuelve si la clave estaba, y en ese caso copia su valor en
+ * valor (si no es NULL). nombre_siguiente recorre los pares sin iterador:
+ *
+ *     size_t pos = 0;
+ *     for (const contador_entrada_t *e; (e = contador_siguiente(contador, &pos)); )
+ *         ...
+ */
+
+/* Funciones para usar como fn_hash y fn_igual. Las de cadenas no copian las
+ * claves: tienen que vivir mientras estén en el hash.
+ */
+static inline uint64_t hash_tipado_u64(uint64_t clave) {
+    /* Mezcla final de MurmurHash3: cada bit de la entrada cambia la mitad de
+     * los de la salida. */
+    clave ^= clave >> 33;
+    clave *= 0xff51afd7ed558ccdULL;
+    clave ^= clave >> 33;
+    clave *= 0xc4ceb9fe1a85ec53ULL;
+    clave ^= clave >> 33;
+    return clave;
+}
+
+static inline bool hash_tipado_igual_u64(uint64_t a, uint64_t b) {
+    return a == b;
+}
+
+static inline uint64_t hash_tipado_cadena(const char *clave) {
+    return wyhash(clave, strlen(clave), 0);
+}
+
+static inline bool hash_tipado_igual_cadena(const char *a, const char *b) {
+    return strcmp(a, b) == 0;
+}
+
+/* Bytes de control, con la misma codificación que HASH_CERRADO en hash.c */
+#define HASH_TIPADO_VACIO 0x80
+#define HASH_TIPADO_BORRADO 0xFE
+#define HASH_TIPADO_ES_LIBRE(c) ((c) & 0x80)
+#define HASH_TIPADO_H2(h) ((uint8_t) ((h) & 0x7F))
+#define HASH_TIPADO_H1(h) ((size_t) ((h) >> 7))
+#define HASH_TIPADO_TAM_INICIAL 16
+/* Carga máxima, en décimos, contando los borrados */
+#define HASH_TIPADO_CARGA_MAX 7
+
+#define HASH_DEFINIR(nombre, tipo_clave, tipo_valor, fn_hash, fn_igual)                             \
+                                                                                                    \
+typedef struct nombre##_entrada {                                                                   \
+    tipo_clave clave;                                                                               \
+    tipo_valor valor;                                                                               \
+} nombre##_entrada_t;                                                                               \
+                                                                                                    \
+typedef struct nombre {                                                                             \
+    uint8_t *ctrl;                                                                                  \
+    nombre##_entrada_t *entradas;                                                                   \
+    size_t tam;                                                                                     \
+    size_t cant;                                                                                    \
+    size_t borrados;                                                                                \
+} nombre##_t;                                                                                       \
+                                                                                                    \
+static inline bool nombre##_tabla_crear(nombre##_t *hash, size_t tam) {                             \
+    uint8_t *ctrl = malloc(tam);                                                                    \
+    nombre##_entrada_t *entradas = malloc(tam * sizeof(nombre##_entrada_t));                        \
+    if (ctrl == NULL || entradas == NULL) {                                                         \
+        free(ctrl);                                                                                 \
+        free(entradas);                                                                             \
+        return false;                                                                               \
+    }                                                                                               \
+    memset(ctrl, HASH_TIPADO_VACIO, tam);                                                           \
+    hash->ctrl = ctrl;                                                                              \
+    hash->entradas = entradas;                                                                      \
+    hash->tam = tam;                                                                                \
+    hash->cant = 0;                                                                                 \
+    hash->borrados = 0;                                                                             \
+    return true;                                                                                    \
+}                                                                                                   \
+                                                                                                    \
+static inline nombre##_t *nombre##_crear(void) {                                                    \
+    nombre##_t *hash = malloc(sizeof(nombre##_t));                                                  \
+    if (hash == NULL || !nombre##_tabla_crear(hash, HASH_TIPADO_TAM_INICIAL)) {                     \
+        free(hash);                                                                                 \
+        return NULL;                                                                                \
+    }                                                                                               \
+    return hash;                                                                                    \
+}                                                                                                   \
+                                                                                                    \
+static inline void nombre##_destruir(nombre##_t *hash) {                                            \
+    free(hash->ctrl);                                                                               \
+    free(hash->entradas);                                                                           \
+    free(hash);                                                                                     \
+}                                                                                                   \
+                                                                                                    \
+/* Devuelve la posición de la clave, o tam si no está. */                                           \
+static inline size_t nombre##_buscar(const nombre##_t *hash, tipo_clave clave, uint64_t h) {        \
+    size_t mascara = hash->tam - 1;                                                                 \
+    uint8_t h2 = HASH_TIPADO_H2(h);                                                                 \
+    for (size_t pos = HASH_TIPADO_H1(h) & mascara;; pos = (pos + 1) & mascara) {                    \
+        uint8_t c = hash->ctrl[pos];                                                                \
+        if (c == h2 && fn_igual(hash->entradas[pos].clave, clave)) {                                \
+            return pos;                                                                             \
+        }                                                                                           \
+        if (c == HASH_TIPADO_VACIO) {                                                               \
+            return hash->tam;                                                                       \
+        }                                                                                           \
+    }                                                                                               \
+}                                                                                                   \
+                                                                                                    \
+/* Devuelve la posición de la clave si está (y encontrada en true), o la                          \
+ * primera libre de su recorrido. */                                                                \
+static inline size_t nombre##_posicion(const nombre##_t *hash, tipo_clave clave, uint64_t h,       \
+                                       bool *encontrada) {                                          \
+    size_t mascara = hash->tam - 1;                                                                 \
+    uint8_t h2 = HASH_TIPADO_H2(h);                                                                 \
+    size_t libre = hash->tam;                                                                       \
+    for (size_t pos = HASH_TIPADO_H1(h) & mascara;; pos = (pos + 1) & mascara) {                    \
+        uint8_t c = hash->ctrl[pos];                                                                \
+        if (c == h2 && fn_igual(hash->entradas[pos].clave, clave)) {                                \
+            *encontrada = true;                                                                     \
+            return pos;                                                                             \
+        }                                                                                           \
+        if (c == HASH_TIPADO_BORRADO && libre == hash->tam) {                                       \
+            libre = pos;                                                                            \
+        }                                                                                           \
+        if (c == HASH_TIPADO_VACIO) {                                                               \
+            *encontrada = false;                                                                    \
+            return libre < hash->tam ? libre : pos;                                                 \
+        }                                                                                           \
+    }                                                                                               \
+}                                                                                                   \
+                                                                                                    \
+static inline bool nombre##_redimensionar(nombre##_t *hash, size_t tam) {                           \
+    nombre##_t nuevo;                                                                               \
+    if (!nombre##_tabla_crear(&nuevo, tam)) {                                                       \
+        return false;                                                                               \
+    }                                                                                               \
+    for (size_t i = 0; i < hash->tam; i++) {                                                        \
+        if (HASH_TIPADO_ES_LIBRE(hash->ctrl[i])) {                                                  \
+            continue;                                                                               \
+        }                                                                                           \
+        uint64_t h = fn_hash(hash->entradas[i].clave);                                              \
+        size_t pos = HASH_TIPADO_H1(h) & (tam - 1);                                                 \
+        while (nuevo.ctrl[pos] != HASH_TIPADO_VACIO) {                                              \
+            pos = (pos + 1) & (tam - 1);                                                            \
+        }                                                                                           \
+        nuevo.ctrl[pos] = HASH_TIPADO_H2(h);                                                        \
+        nuevo.entradas[pos] = hash->entradas[i];                                                    \
+    }                                                                                               \
+    nuevo.cant = hash->cant;                                                                        \
+    free(hash->ctrl);                                                                               \
+    free(hash->entradas);                                                                           \
+    *hash = nuevo;                                                                                  \
+    return true;                                                                                    \
+}                                                                                                   \
+                                                                                                    \
+static inline tipo_valor *nombre##_obtener_o_insertar(nombre##_t *hash, tipo_clave clave,          \
+                                                      bool *insertado) {                            \
+    uint64_t h = fn_hash(clave);                                                                    \
+    bool encontrada;                                                                                \
+    size_t pos = nombre##_posicion(hash, clave, h, &encontrada);                                    \
+    if (!encontrada) {                                                                              \
+        if ((hash->cant + hash->borrados + 1) * 10 > hash->tam * HASH_TIPADO_CARGA_MAX) {           \
+            /* Si la mayoría de lo ocupado son borrados, alcanza con limpiarlos. */                 \
+            size_t tam = hash->borrados > hash->cant ? hash->tam : hash->tam * 2;                   \
+            if (!nombre##_redimensionar(hash, tam)) {                                               \
+                return NULL;                                                                        \
+            }                                                                                       \
+            pos = nombre##_posicion(hash, clave, h, &encontrada);                                   \
+        }                                                                                           \
+        if (hash->ctrl[pos] == HASH_TIPADO_BORRADO) {                                               \
+            hash->borrados--;                                                                       \
+        }                                                                                           \
+        hash->ctrl[pos] = HASH_TIPADO_H2(h);                                                        \
+        hash->entradas[pos].clave = clave;                                                          \
+        memset(&hash->entradas[pos].valor, 0, sizeof(tipo_valor));                                  \
+        hash->cant++;                                                                               \
+    }                                                                                               \
+    if (insertado != NULL) {                                                                        \
+        *insertado = !encontrada;                                                                   \
+    }                                                                                               \
+    return &hash->entradas[pos].valor;                                                              \
+}                                                                                                   \
+                                                                                                    \
+static inline bool nombre##_guardar(nombre##_t *hash, tipo_clave clave, tipo_valor valor) {         \
+    tipo_valor *destino = nombre##_obtener_o_insertar(hash, clave, NULL);                           \
+    if (destino == NULL) {                                                                          \
+        return false;                                                                               \
+    }                                                                                               \
+    *destino = valor;                                                                               \
+    return true;                                                                                    \
+}                                                                                                   \
+                                                                                                    \
+static inline tipo_valor *nombre##_obtener(const nombre##_t *hash, tipo_clave clave) {              \
+    size_t pos = nombre##_buscar(hash, clave, fn_hash(clave));                                      \
+    return pos < hash->tam ? &hash->entradas[pos].valor : NULL;                                     \
+}                                                                                                   \
+                                                                                                    \
+static inline bool nombre##_pertenece(const nombre##_t *hash, tipo_clave clave) {                   \
+    return nombre##_buscar(hash, clave, fn_hash(clave)) < hash->tam;                                \
+}                                                                                                   \
+                                                                                                    \
+static inline bool nombre##_borrar(nombre##_t *hash, tipo_clave clave, tipo_valor *valor) {         \
+    size_t pos = nombre##_buscar(hash, clave, fn_hash(clave));                                      \
+    if (pos == hash->tam) {                                                                         \
+        return false;                                                                               \
+    }                                                                                               \
+    if (valor != NULL) {                                                                            \
+        *valor = hash->entradas[pos].valor;                                                         \
+    }                                                                                               \
+    /* Con sondeo lineal, si la siguiente está vacía ningún recorrido pasa                        \
+     * por acá para seguir de largo: puede quedar vacía en vez de borrada. */                       \
+    if (hash->ctrl[(pos + 1) & (hash->tam - 1)] == HASH_TIPADO_VACIO) {                             \
+        hash->ctrl[pos] = HASH_TIPADO_VACIO;                                                        \
+    } else {                                                                                        \
+        hash->ctrl[pos] = HASH_TIPADO_BORRADO;                                                      \
+        hash->borrados++;                                                                           \
+    }                                                                                               \
+    hash->cant--;                                                                                   \
+    return true;                                                                                    \
+}                                                                                                   \
+                                                                                                    \
+static inline size_t nombre##_cantidad(const nombre##_t *hash) {                                    \
+    return hash->cant;                                                                              \
+}                                                                                                   \
+                                                                                                    \
+static inline const nombre##_entrada_t *nombre##_siguiente(const nombre##_t *hash, size_t *pos) {   \
+    while (*pos < hash->tam) {                                                                      \
+        size_t i = (*pos)++;                                                                        \
+        if (!HASH_TIPADO_ES_LIBRE(hash->ctrl[i])) {                                                 \
+            return &hash->entradas[i];                                                              \
+        }                                                                                           \
+    }                                                                                               \
+    return NULL;                                                                                    \
+}
+
+#endif  // HASH_TIPADO_H
@@ -0,0 +1,143 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "hash_u64.h"
+#include "hash_tipado.h"
+
+#ifdef __linux__
+#include <sys/random.h>
+#endif
+
+// ********** Definiciones **********
+
+// Semilla común a todos los hash_u64_t del proceso: el hash de una clave
+// tiene que poder calcularse sólo con la clave (ver HASH_DEFINIR).
+static uint64_t semilla;
+static pthread_once_t semilla_elegida = PTHREAD_ONCE_INIT;
+
+static void semilla_elegir(void){
+#ifdef __linux__
+	if (getrandom(&semilla, sizeof(semilla), GRND_NONBLOCK) == (ssize_t) sizeof(semilla)){
+		return;
+	}
+#endif
+	semilla = hash_tipado_u64((uint64_t) time(NULL) ^ (uint64_t) getpid() << 32);
+}
+
+// La mezcla es biyectiva, así que dos claves distintas nunca tienen el mismo
+// hash completo; con la semilla, tampoco se pueden elegir claves que caigan
+// en la misma posición.
+static uint64_t clave_mezclar(uint64_t clave){
+	return hash_tipado_u64(clave ^ semilla);
+}
+
+HASH_DEFINIR(tabla_u64, uint64_t, void*, clave_mezclar, hash_tipado_igual_u64)
+
+struct hash_u64{
+	tabla_u64_t* tabla;
+	hash_destruir_dato_t destruir_dato;
+};
+
+struct hash_u64_iter{
+	const hash_u64_t* hash;
+	size_t pos;						// Próxima posición a revisar.
+	const tabla_u64_entrada_t* actual;	// NULL al terminar.
+};
+
+// ********** Primitivas **********
+
+hash_u64_t *hash_u64_crear(hash_destruir_dato_t destruir_dato){
+	pthread_once(&semilla_elegida, semilla_elegir);
+	hash_u64_t* hash = malloc(sizeof(hash_u64_t));
+	if (hash == NULL){
+		return NULL;
+	}
+	hash->tabla = tabla_u64_crear();
+	if (hash->tabla == NULL){
+		free(hash);
+		return NULL;
+	}
+	hash->destruir_dato = destruir_dato;
+	return hash;
+}
+
+bool hash_u64_guardar(hash_u64_t *hash, uint64_t clave, void *dato){
+	bool insertado;
+	void** destino = tabla_u64_obtener_o_insertar(hash->tabla, clave, &insertado);
+	if (destino == NULL){
+		return false;
+	}
+	if (!insertado && hash->destruir_dato){
+		hash->destruir_dato(*destino);
+	}
+	*destino = dato;
+	return true;
+}
+
+void *hash_u64_borrar(hash_u64_t *hash, uint64_t clave){
+	void* dato = NULL;
+	tabla_u64_borrar(hash->tabla, clave, &dato);
+	return dato;
+}
+
+void *hash_u64_obtener(const hash_u64_t *hash, uint64_t clave){
+	void** dato = tabla_u64_obtener(hash->tabla, clave);
+	return dato ? *dato : NULL;
+}
+
+bool hash_u64_pertenece(const hash_u64_t *hash, uint64_t clave){
+	return tabla_u64_pertenece(hash->tabla, clave);
+}
+
+size_t hash_u64_cantidad(const hash_u64_t *hash){
+	return tabla_u64_cantidad(hash->tabla);
+}
+
+void hash_u64_destruir(hash_u64_t *hash){
+	if (hash->destruir_dato){
+		size_t pos = 0;
+		for (const tabla_u64_entrada_t* entrada; (entrada = tabla_u64_siguiente(hash->tabla, &pos));){
+			hash->destruir_dato(entrada->valor);
+		}
+	}
+	tabla_u64_destruir(hash->tabla);
+	free(hash);
+}
+
+/* Iterador del hash */
+
+hash_u64_iter_t *hash_u64_iter_crear(const hash_u64_t *hash){
+	hash_u64_iter_t* iter = malloc(sizeof(hash_u64_iter_t));
+	if (iter == NULL){
+		return NULL;
+	}
+	iter->hash = hash;
+	iter->pos = 0;
+	iter->actual = tabla_u64_siguiente(hash->tabla, &iter->pos);
+	return iter;
+}
+
+bool hash_u64_iter_avanzar(hash_u64_iter_t *iter){
+	if (hash_u64_iter_al_final(iter)){
+		return false;
+	}
+	iter->actual = tabla_u64_siguiente(iter->hash->tabla, &iter->pos);
+	return true;
+}
+
+uint64_t hash_u64_iter_ver_actual(const hash_u64_iter_t *iter){
+	return iter->actual ? iter->actual->clave : 0;
+}
+
+void *hash_u64_iter_ver_dato(const hash_u64_iter_t *iter){
+	return iter->actual ? iter->actual->valor : NULL;
+}
+
+bool hash_u64_iter_al_final(const hash_u64_iter_t *iter){
+	return iter->actual == NULL;
+}
+
+void hash_u64_iter_destruir(hash_u64_iter_t *iter){
+	free(iter);
+}
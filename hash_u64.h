@@ -0,0 +1,78 @@
+#ifndef HASH_U64_H
+#define HASH_U64_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hash.h"
+
+// Hash con claves uint64_t, para cuando las claves son identificadores
+// numéricos: evita convertirlas a texto para usar hash_t. Claves y datos se
+// guardan juntos en un único arreglo (ver hash_tipado.h), sin pedir memoria
+// por cada par. Las primitivas se comportan como las de hash.h.
+struct hash_u64;
+struct hash_u64_iter;
+
+typedef struct hash_u64 hash_u64_t;
+typedef struct hash_u64_iter hash_u64_iter_t;
+
+/* Crea el hash. Las claves se mezclan con una semilla aleatoria elegida una
+ * vez por proceso.
+ */
+hash_u64_t *hash_u64_crear(hash_destruir_dato_t destruir_dato);
+
+/* Guarda un elemento en el hash; si la clave ya se encuentra, reemplaza su
+ * dato. De no poder guardarlo devuelve false.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_u64_guardar(hash_u64_t *hash, uint64_t clave, void *dato);
+
+/* Borra un elemento del hash y devuelve el dato asociado. Devuelve NULL si
+ * la clave no estaba.
+ * Pre: La estructura hash fue inicializada
+ */
+void *hash_u64_borrar(hash_u64_t *hash, uint64_t clave);
+
+/* Obtiene el dato de una clave, o NULL si no se encuentra.
+ * Pre: La estructura hash fue inicializada
+ */
+void *hash_u64_obtener(const hash_u64_t *hash, uint64_t clave);
+
+/* Determina si la clave pertenece o no al hash.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_u64_pertenece(const hash_u64_t *hash, uint64_t clave);
+
+/* Devuelve la cantidad de elementos del hash.
+ * Pre: La estructura hash fue inicializada
+ */
+size_t hash_u64_cantidad(const hash_u64_t *hash);
+
+/* Destruye la estructura liberando la memoria pedida y llamando a la función
+ * destruir para cada par (clave, dato).
+ * Pre: La estructura hash fue inicializada
+ * Post: La estructura hash fue destruida
+ */
+void hash_u64_destruir(hash_u64_t *hash);
+
+/* Iterador del hash. No se puede modificar el hash mientras se lo usa. */
+
+// Crea iterador
+hash_u64_iter_t *hash_u64_iter_crear(const hash_u64_t *hash);
+
+// Avanza iterador
+bool hash_u64_iter_avanzar(hash_u64_iter_t *iter);
+
+// Devuelve la clave actual, o 0 si terminó la iteración.
+uint64_t hash_u64_iter_ver_actual(const hash_u64_iter_t *iter);
+
+// Devuelve el dato de la clave actual, o NULL si terminó la iteración.
+void *hash_u64_iter_ver_dato(const hash_u64_iter_t *iter);
+
+// Comprueba si terminó la iteración
+bool hash_u64_iter_al_final(const hash_u64_iter_t *iter);
+
+// Destruye iterador
+void hash_u64_iter_destruir(hash_u64_iter_t *iter);
+
+#endif  // HASH_U64_H
@@ -15,6 +15,7 @@ struct lista{
 	struct nodo* prim;
 	struct nodo* ult;
 	size_t largo;
+	pool_t* pool;	// De donde salen los nodos; NULL si se piden con malloc.
 };
 
 struct lista_iter{
@@ -23,8 +24,8 @@ struct lista_iter{
 	lista_t* lista;
 };
 
-nodo_t *nodo_crear(void *dato){
-	nodo_t *nuevo = malloc(sizeof(nodo_t));
+nodo_t *nodo_crear(lista_t *lista, void *dato){
+	nodo_t *nuevo = lista->pool ? pool_pedir(lista->pool) : malloc(sizeof(nodo_t));
 	if (nuevo == NULL){
 		return NULL;
 	}
@@ -32,11 +33,23 @@ nodo_t *nodo_crear(void *dato){
 	return nuevo;
 }
 
+void nodo_destruir(lista_t *lista, nodo_t *nodo){
+	if (lista->pool){
+		pool_devolver(lista->pool, nodo);
+	} else{
+		free(nodo);
+	}
+}
+
 /*******************************************************************
  *                    PRIMITIVAS DE LA PILA						   *
  *******************************************************************/
 
 lista_t *lista_crear(void){
+	return lista_crear_con_pool(NULL);
+}
+
+lista_t *lista_crear_con_pool(pool_t *pool){
 	lista_t *lista = malloc(sizeof(lista_t));
 	if (lista == NULL){
 		return NULL;
@@ -44,15 +57,28 @@ lista_t *lista_crear(void){
 	lista->ult = NULL;
 	lista->prim = NULL;
 	lista->largo = 0;
+	lista->pool = pool;
 	return lista;
 }
 
+void lista_cambiar_pool(lista_t *lista, pool_t *pool){
+	lista->pool = pool;
+}
+
+pool_t *lista_pool_crear(void){
+	return pool_crear(sizeof(nodo_t));
+}
+
+size_t lista_tam(void){
+	return sizeof(lista_t);
+}
+
 bool lista_esta_vacia(const lista_t* lista){
 	return lista->largo == 0;
 }
 
 bool lista_insertar_primero(lista_t *lista, void *dato){
-	nodo_t *nuevo = nodo_crear(dato);
+	nodo_t *nuevo = nodo_crear(lista, dato);
 	if (nuevo == NULL){
 		return false;
 	}
@@ -74,7 +100,7 @@ bool lista_insertar_ultimo(lista_t *lista, void *dato){
 		return lista_insertar_primero(lista, dato);
 	}
 
-	nodo_t *nuevo = nodo_crear(dato);
+	nodo_t *nuevo = nodo_crear(lista, dato);
 	if (nuevo == NULL){
 		return false;
 	}
@@ -110,7 +136,7 @@ void *lista_borrar_primero(lista_t *lista){
 	void *valor = lista->prim->dato;
 	nodo_t *nodo_aux = lista->prim;
 	lista->prim = lista->prim->prox;
-	free(nodo_aux);
+	nodo_destruir(lista, nodo_aux);
 	lista->largo--;
 	if (lista_esta_vacia(lista)){
 		lista->ult = NULL;	
@@ -144,6 +170,46 @@ void lista_iterar(lista_t *lista, bool visitar(void *dato, void *extra), void *e
 	}
 }
 
+void *lista_buscar_y_borrar(lista_t *lista, bool es_buscado(void *dato, void *extra), void *extra){
+	nodo_t *ant = NULL;
+	nodo_t *nodo = lista->prim;
+	while (nodo != NULL && !es_buscado(nodo->dato, extra)){
+		ant = nodo;
+		nodo = nodo->prox;
+	}
+	if (nodo == NULL){
+		return NULL;
+	}
+	if (ant == NULL){
+		lista->prim = nodo->prox;
+	} else{
+		ant->prox = nodo->prox;
+	}
+	if (lista->ult == nodo){
+		lista->ult = ant;
+	}
+	lista->largo--;
+	void *valor = nodo->dato;
+	nodo_destruir(lista, nodo);
+	return valor;
+}
+
+//RECORRIDO POR POSICIONES:
+
+lista_pos_t lista_pos_primera(const lista_t *lista){
+	return lista->prim;
+}
+
+lista_pos_t lista_pos_siguiente(lista_pos_t pos){
+	const nodo_t *nodo = pos;
+	return nodo->prox;
+}
+
+void *lista_pos_ver(lista_pos_t pos){
+	const nodo_t *nodo = pos;
+	return nodo->dato;
+}
+
 //ITERADOR EXTERNO:
 
 lista_iter_t *lista_iter_crear(lista_t *lista){
@@ -195,7 +261,7 @@ bool lista_iter_insertar(lista_iter_t *iter, void *dato){
 		return true;
 	}
 
-	nodo_t *nuevo = nodo_crear(dato);
+	nodo_t *nuevo = nodo_crear(iter->lista, dato);
 	if (nuevo == NULL){
 		return false;
 	}
@@ -234,7 +300,7 @@ void *lista_iter_borrar(lista_iter_t *iter){
 		iter->ant->prox = iter->actual;
 	}	
 	iter->lista->largo--;
-	free(nodo);
+	nodo_destruir(iter->lista, nodo);
 	return valor;
 }
 
@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include <stdlib.h>
+#include "pool.h"
 
 /*******************************************************************
  *                DEFINICION DE LOS TIPOS DE DATOS				   *
@@ -22,6 +23,25 @@ typedef struct lista_iter lista_iter_t;
 // Pos: Devuelve una lista vacía.
 lista_t *lista_crear(void);
 
+// Crea una lista cuyos nodos salen de pool y vuelven a él al borrarse, en
+// lugar de pedirse con malloc. Varias listas pueden compartir un mismo pool.
+// Pre: pool fue creado con lista_pool_crear, y se destruye después que la lista.
+// Pos: Devuelve una lista vacía.
+lista_t *lista_crear_con_pool(pool_t *pool);
+
+// Cambia el pool del que salen los nodos nuevos y al que vuelven los borrados.
+// Pre: La lista fue creada con lista_crear_con_pool, y los nodos que ya tiene
+// salieron de pool o de un pool que se fusionó (o se va a fusionar, antes de
+// volver a usar la lista) con él.
+void lista_cambiar_pool(lista_t *lista, pool_t *pool);
+
+// Crea un pool de nodos para usar con lista_crear_con_pool.
+// Pos: Devuelve un pool vacío, o NULL si no hay memoria. Se destruye con pool_destruir.
+pool_t *lista_pool_crear(void);
+
+// Devuelve la cantidad de bytes que ocupa una lista, sin contar sus nodos.
+size_t lista_tam(void);
+
 // Devuelve verdadero si la lista contiene elementos, falso en caso contrario.
 // Pre: La lista fue creada.
 bool lista_esta_vacia(const lista_t* lista);
@@ -76,6 +96,29 @@ void lista_destruir(lista_t *lista, void destruir_dato(void *));
 // Post: La lista se iteró hasta el final o hasta que se cumplió la condición de corte de visitar.
 void lista_iterar(lista_t *lista, bool visitar(void *dato, void *extra), void *extra);
 
+// Quita de la lista el primer elemento para el que es_buscado devuelve verdadero,
+// y devuelve su valor. Si ninguno cumple, devuelve NULL.
+// Pre: La lista fue creada.
+// Post: La lista contiene un elemento menos si alguno cumplía.
+void *lista_buscar_y_borrar(lista_t *lista, bool es_buscado(void *dato, void *extra), void *extra);
+
+//RECORRIDO POR POSICIONES:
+
+// Posición de un elemento de la lista, para recorrerla sin pedir memoria.
+typedef const void *lista_pos_t;
+
+// Devuelve la posición del primer elemento, o NULL si la lista está vacía.
+// Pre: La lista fue creada.
+lista_pos_t lista_pos_primera(const lista_t *lista);
+
+// Devuelve la posición siguiente a pos, o NULL si pos es la última.
+// Pre: pos es una posición de la lista, que no se modificó desde que se obtuvo.
+lista_pos_t lista_pos_siguiente(lista_pos_t pos);
+
+// Devuelve el elemento en la posición pos.
+// Pre: pos es una posición de la lista, que no se modificó desde que se obtuvo.
+void *lista_pos_ver(lista_pos_t pos);
+
 //ITERADOR EXTERNO:
 
 // Crea un iterador
@@ -0,0 +1,121 @@
+#include "pool.h"
+#include <stddef.h>
+
+// Tamaño aproximado de cada bloque de objetos.
+#define TAM_BLOQUE (64 * 1024)
+
+/*******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS				   *
+ *******************************************************************/
+
+// Un objeto devuelto guarda en sus primeros bytes al siguiente libre.
+typedef struct libre{
+	struct libre* sig;
+}libre_t;
+
+typedef struct bloque{
+	struct bloque* sig;
+	max_align_t alineacion[];	// Los objetos empiezan acá.
+}bloque_t;
+
+struct pool{
+	libre_t* libres;
+	bloque_t* bloques;
+	char* proximo;		// Primer objeto sin usar del último bloque.
+	char* fin;			// Fin del último bloque.
+	size_t tam_objeto;
+	size_t memoria;
+};
+
+/*******************************************************************
+ *                    PRIMITIVAS DEL POOL						   *
+ *******************************************************************/
+
+pool_t *pool_crear(size_t tam_objeto){
+	pool_t *pool = malloc(sizeof(pool_t));
+	if (pool == NULL){
+		return NULL;
+	}
+	// Cada objeto tiene que poder guardar el puntero de la lista de libres, y
+	// quedar alineado como lo dejaría malloc.
+	size_t alineacion = _Alignof(max_align_t);
+	if (tam_objeto < sizeof(libre_t)){
+		tam_objeto = sizeof(libre_t);
+	}
+	pool->tam_objeto = (tam_objeto + alineacion - 1) / alineacion * alineacion;
+	pool->libres = NULL;
+	pool->bloques = NULL;
+	pool->proximo = NULL;
+	pool->fin = NULL;
+	pool->memoria = 0;
+	return pool;
+}
+
+void *pool_pedir(pool_t *pool){
+	if (pool->libres != NULL){
+		libre_t *objeto = pool->libres;
+		pool->libres = objeto->sig;
+		return objeto;
+	}
+	if (pool->proximo == pool->fin){
+		size_t objetos = TAM_BLOQUE / pool->tam_objeto;
+		if (objetos == 0){
+			objetos = 1;
+		}
+		size_t tam = sizeof(bloque_t) + objetos * pool->tam_objeto;
+		bloque_t *bloque = malloc(tam);
+		if (bloque == NULL){
+			return NULL;
+		}
+		bloque->sig = pool->bloques;
+		pool->bloques = bloque;
+		pool->proximo = (char*) bloque->alineacion;
+		pool->fin = pool->proximo + objetos * pool->tam_objeto;
+		pool->memoria += tam;
+	}
+	void *objeto = pool->proximo;
+	pool->proximo += pool->tam_objeto;
+	return objeto;
+}
+
+void pool_devolver(pool_t *pool, void *objeto){
+	libre_t *libre = objeto;
+	libre->sig = pool->libres;
+	pool->libres = libre;
+}
+
+void pool_fusionar(pool_t *destino, pool_t *origen){
+	// Lo que quedaba sin usar del último bloque de origen pasa a estar libre.
+	for (; origen->proximo != origen->fin; origen->proximo += origen->tam_objeto){
+		pool_devolver(destino, origen->proximo);
+	}
+	while (origen->libres != NULL){
+		libre_t *libre = origen->libres;
+		origen->libres = libre->sig;
+		pool_devolver(destino, libre);
+	}
+	if (origen->bloques != NULL){
+		bloque_t *ultimo = origen->bloques;
+		while (ultimo->sig != NULL){
+			ultimo = ultimo->sig;
+		}
+		ultimo->sig = destino->bloques;
+		destino->bloques = origen->bloques;
+	}
+	destino->memoria += origen->memoria;
+	free(origen);
+}
+
+size_t pool_memoria(const pool_t *pool){
+	return pool->memoria;
+}
+
+void pool_destruir(pool_t *pool){
+	bloque_t *bloque = pool->bloques;
+	while (bloque != NULL){
+		bloque_t *sig = bloque->sig;
+		free(bloque);
+		bloque = sig;
+	}
+	free(pool);
+}
@@ -0,0 +1,50 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdlib.h>
+
+/*******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS				   *
+ *******************************************************************/
+
+// Pool de objetos de un mismo tamaño: los pide al sistema de a bloques
+// grandes y recicla los devueltos con una lista de libres, de modo que
+// pedir y devolver no pasan por malloc ni free.
+struct pool;
+typedef struct pool pool_t;
+
+
+/*******************************************************************
+ *                    PRIMITIVAS DEL POOL						   *
+ *******************************************************************/
+
+// Crea un pool de objetos de tam_objeto bytes.
+// Pos: Devuelve un pool vacío, o NULL si no hay memoria.
+pool_t *pool_crear(size_t tam_objeto);
+
+// Devuelve un objeto sin inicializar, o NULL si no hay memoria.
+// Pre: El pool fue creado.
+void *pool_pedir(pool_t *pool);
+
+// Devuelve al pool un objeto obtenido con pool_pedir, para reusarlo.
+// Pre: El pool fue creado y objeto salió de él.
+void pool_devolver(pool_t *pool, void *objeto);
+
+// Pasa todos los bloques y objetos libres de origen a destino, y destruye
+// origen. Sirve para que varios hilos llenen pools propios y después se
+// junten en uno.
+// Pre: Ambos pools fueron creados con el mismo tam_objeto.
+// Post: Los objetos pedidos a origen viven hasta que se destruya destino, y
+// se devuelven a destino.
+void pool_fusionar(pool_t *destino, pool_t *origen);
+
+// Devuelve la cantidad de bytes pedidos en bloques por el pool.
+// Pre: El pool fue creado.
+size_t pool_memoria(const pool_t *pool);
+
+// Destruye el pool junto con todos sus objetos, devueltos o no.
+// Pre: El pool fue creado.
+// Post: Se liberaron todos los bloques.
+void pool_destruir(pool_t *pool);
+
+#endif  // POOL_H
@@ -0,0 +1,179 @@
+#include "rueda.h"
+#include <stdlib.h>
+
+// Cada nivel tiene 2^BITS_POR_NIVEL baldes, y un balde de un nivel abarca un
+// giro entero del nivel de abajo.
+#define BITS_POR_NIVEL 6
+#define BALDES (1u << BITS_POR_NIVEL)
+#define MASCARA (BALDES - 1)
+// Con 6 niveles entran vencimientos hasta 2^36 unidades después del tiempo
+// actual (más de dos años en milisegundos); los más lejanos esperan aparte.
+#define NIVELES 6
+#define ALCANCE (NIVELES * BITS_POR_NIVEL)
+
+/*******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS				   *
+ *******************************************************************/
+
+// Un temporizador pendiente está en el nivel del dígito más alto (en base
+// BALDES) en que su vencimiento difiere de actual, en el balde de ese dígito.
+// Así los baldes ocupados de cada nivel están adelante del dígito de actual,
+// y cuando actual llega al comienzo de uno, su contenido baja de nivel.
+struct rueda{
+	uint64_t actual;	// Lo que vence hasta acá, inclusive, está en vencidos.
+	temporizador_t* baldes[NIVELES][BALDES];
+	// Bit i en 1 si el balde i del nivel tiene temporizadores. Al quitar uno
+	// no se apaga: un balde vacío con el bit prendido sólo cuesta bajarlo.
+	uint64_t ocupados[NIVELES];
+	temporizador_t* lejanos;	// Los que vencen fuera del alcance de los niveles.
+	// Cota inferior de los vencimientos de lejanos: quitar uno no la sube,
+	// pero se recalcula cada vez que bajan.
+	uint64_t lejano_minimo;
+	temporizador_t* vencidos;
+	size_t cantidad;
+};
+
+/*******************************************************************
+ *                        AUXILIARES							   *
+ *******************************************************************/
+
+static void enlazar(temporizador_t** cabeza, temporizador_t* temporizador){
+	temporizador->sig = *cabeza;
+	if (*cabeza != NULL){
+		(*cabeza)->ant = &temporizador->sig;
+	}
+	*cabeza = temporizador;
+	temporizador->ant = cabeza;
+}
+
+static void desenlazar(temporizador_t* temporizador){
+	*temporizador->ant = temporizador->sig;
+	if (temporizador->sig != NULL){
+		temporizador->sig->ant = temporizador->ant;
+	}
+}
+
+static void rueda_ubicar(rueda_t* rueda, temporizador_t* temporizador){
+	if (temporizador->vence <= rueda->actual){
+		enlazar(&rueda->vencidos, temporizador);
+		return;
+	}
+	unsigned bit = 63 - (unsigned) __builtin_clzll(temporizador->vence ^ rueda->actual);
+	unsigned nivel = bit / BITS_POR_NIVEL;
+	if (nivel >= NIVELES){
+		enlazar(&rueda->lejanos, temporizador);
+		if (temporizador->vence < rueda->lejano_minimo){
+			rueda->lejano_minimo = temporizador->vence;
+		}
+		return;
+	}
+	unsigned balde = (unsigned) (temporizador->vence >> (nivel * BITS_POR_NIVEL)) & MASCARA;
+	enlazar(&rueda->baldes[nivel][balde], temporizador);
+	rueda->ocupados[nivel] |= 1ULL << balde;
+}
+
+// Busca el próximo momento en que hay que bajar un balde: el comienzo del
+// primer balde ocupado del nivel más bajo que tenga alguno adelante, o si
+// sólo hay lejanos, el giro del último nivel en que vence el primero de ellos
+// (así un salto largo no los vuelve a ubicar en cada giro intermedio).
+// Devuelve false si no hay temporizadores pendientes.
+static bool rueda_proximo(const rueda_t* rueda, uint64_t* momento, unsigned* nivel, unsigned* balde){
+	for (unsigned n = 0; n < NIVELES; n++){
+		unsigned corrimiento = n * BITS_POR_NIVEL;
+		unsigned digito = (unsigned) (rueda->actual >> corrimiento) & MASCARA;
+		uint64_t adelante = digito == MASCARA ? 0 : rueda->ocupados[n] & (~0ULL << (digito + 1));
+		if (adelante != 0){
+			*nivel = n;
+			*balde = (unsigned) __builtin_ctzll(adelante);
+			uint64_t giro = rueda->actual >> (corrimiento + BITS_POR_NIVEL) << (corrimiento + BITS_POR_NIVEL);
+			*momento = giro | (uint64_t) *balde << corrimiento;
+			return true;
+		}
+	}
+	if (rueda->lejanos != NULL){
+		*nivel = NIVELES;
+		*momento = rueda->lejano_minimo >> ALCANCE << ALCANCE;
+		return true;
+	}
+	return false;
+}
+
+// Lleva actual al próximo momento en que hay que bajar un balde y lo baja,
+// si ese momento no pasa de ahora. Si no, lleva actual hasta ahora y
+// devuelve false.
+static bool rueda_girar(rueda_t* rueda, uint64_t ahora){
+	uint64_t momento;
+	unsigned nivel;
+	unsigned balde = 0;
+	if (!rueda_proximo(rueda, &momento, &nivel, &balde) || momento > ahora){
+		if (ahora > rueda->actual){
+			rueda->actual = ahora;
+		}
+		return false;
+	}
+	rueda->actual = momento;
+	temporizador_t* lista;
+	if (nivel == NIVELES){
+		lista = rueda->lejanos;
+		rueda->lejanos = NULL;
+		rueda->lejano_minimo = UINT64_MAX;
+	} else{
+		lista = rueda->baldes[nivel][balde];
+		rueda->baldes[nivel][balde] = NULL;
+		rueda->ocupados[nivel] &= ~(1ULL << balde);
+	}
+	while (lista != NULL){
+		temporizador_t* temporizador = lista;
+		lista = lista->sig;
+		rueda_ubicar(rueda, temporizador);
+	}
+	return true;
+}
+
+/*******************************************************************
+ *                    PRIMITIVAS DE LA RUEDA					   *
+ *******************************************************************/
+
+rueda_t *rueda_crear(uint64_t ahora){
+	rueda_t *rueda = calloc(1, sizeof(rueda_t));
+	if (rueda == NULL){
+		return NULL;
+	}
+	rueda->actual = ahora;
+	rueda->lejano_minimo = UINT64_MAX;
+	return rueda;
+}
+
+void rueda_agregar(rueda_t *rueda, temporizador_t *temporizador, uint64_t vence){
+	temporizador->vence = vence;
+	rueda_ubicar(rueda, temporizador);
+	rueda->cantidad++;
+}
+
+void rueda_quitar(rueda_t *rueda, temporizador_t *temporizador){
+	desenlazar(temporizador);
+	rueda->cantidad--;
+}
+
+uint64_t rueda_vencimiento(const temporizador_t *temporizador){
+	return temporizador->vence;
+}
+
+temporizador_t *rueda_sacar_vencido(rueda_t *rueda, uint64_t ahora){
+	while (rueda->vencidos == NULL && rueda_girar(rueda, ahora));
+	temporizador_t *temporizador = rueda->vencidos;
+	if (temporizador == NULL){
+		return NULL;
+	}
+	desenlazar(temporizador);
+	rueda->cantidad--;
+	return temporizador;
+}
+
+size_t rueda_cantidad(const rueda_t *rueda){
+	return rueda->cantidad;
+}
+
+void rueda_destruir(rueda_t *rueda){
+	free(rueda);
+}
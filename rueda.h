@@ -0,0 +1,66 @@
+#ifndef RUEDA_H
+#define RUEDA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************
+ *                DEFINICION DE LOS TIPOS DE DATOS				   *
+ *******************************************************************/
+
+// Rueda de temporizadores jerárquica: ordena temporizadores por su
+// vencimiento (un entero en cualquier unidad de tiempo) de modo que agregar
+// y quitar uno cuesta O(1), y sacar los vencidos cuesta lo proporcional a
+// cuántos son, sin importar cuántos haya ni cuánto tiempo haya pasado.
+struct rueda;
+typedef struct rueda rueda_t;
+
+// Los temporizadores van dentro de los elementos del usuario, así la rueda
+// no pide memoria por cada uno. Se define acá sólo para eso; sus campos son
+// privados.
+typedef struct temporizador {
+    uint64_t vence;
+    struct temporizador *sig;
+    struct temporizador **ant;	// Campo sig del anterior, o cabeza de la lista.
+} temporizador_t;
+
+/*******************************************************************
+ *                    PRIMITIVAS DE LA RUEDA					   *
+ *******************************************************************/
+
+// Crea una rueda vacía cuyo tiempo actual es ahora.
+// Pos: Devuelve la rueda, o NULL si no hay memoria.
+rueda_t *rueda_crear(uint64_t ahora);
+
+// Agrega un temporizador que vence en el momento vence. Si ya pasó, queda
+// vencido.
+// Pre: La rueda fue creada y temporizador no está en ninguna rueda.
+void rueda_agregar(rueda_t *rueda, temporizador_t *temporizador, uint64_t vence);
+
+// Saca de la rueda un temporizador, vencido o no.
+// Pre: La rueda fue creada y temporizador está en ella.
+void rueda_quitar(rueda_t *rueda, temporizador_t *temporizador);
+
+// Devuelve el momento en que vence el temporizador.
+// Pre: temporizador está en una rueda.
+uint64_t rueda_vencimiento(const temporizador_t *temporizador);
+
+// Avanza el tiempo de la rueda hasta ahora y saca un temporizador vencido
+// (con vencimiento hasta ahora inclusive), o devuelve NULL si no hay. El
+// tiempo de la rueda no retrocede: con un ahora anterior, cuenta como
+// vencido lo que vence hasta el tiempo al que ya había llegado.
+// Pre: La rueda fue creada.
+// Pos: El temporizador devuelto ya no está en la rueda.
+temporizador_t *rueda_sacar_vencido(rueda_t *rueda, uint64_t ahora);
+
+// Devuelve la cantidad de temporizadores en la rueda.
+// Pre: La rueda fue creada.
+size_t rueda_cantidad(const rueda_t *rueda);
+
+// Destruye la rueda. Los temporizadores que tenga son del usuario.
+// Pre: La rueda fue creada.
+// Post: Se liberó la memoria de la rueda.
+void rueda_destruir(rueda_t *rueda);
+
+#endif  // RUEDA_H
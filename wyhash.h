@@ -0,0 +1,82 @@
+#ifndef WYHASH_H
+#define WYHASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Versión reducida de wyhash (github.com/wangyi-fudan/wyhash): lee la clave
+ * de a 8 bytes y la mezcla con multiplicaciones de 64x64 a 128 bits. Está
+ * static inline para que hash_tipado.h la use sin enlazar hash.c; desde
+ * afuera, usar hash_funcion_wyhash de hash.h, que da el mismo resultado.
+ */
+
+static inline uint64_t wyhash_leer64(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t wyhash_leer32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/* Multiplica a y b en 128 bits y deja en a la mitad baja y en b la alta */
+static inline void wyhash_multiplicar128(uint64_t *a, uint64_t *b) {
+    __uint128_t r = (__uint128_t) *a * *b;
+    *a = (uint64_t) r;
+    *b = (uint64_t) (r >> 64);
+}
+
+static inline uint64_t wyhash_mezclar128(uint64_t a, uint64_t b) {
+    wyhash_multiplicar128(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64_t wyhash(const void *clave, size_t largo, uint64_t semilla) {
+    static const uint64_t secreto[4] = {0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL,
+                                        0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL};
+    const uint8_t *p = clave;
+    semilla ^= wyhash_mezclar128(semilla ^ secreto[0], secreto[1]);
+    uint64_t a, b;
+    if (largo <= 16) {
+        if (largo >= 4) {
+            size_t medio = (largo >> 3) << 2;
+            a = (wyhash_leer32(p) << 32) | wyhash_leer32(p + medio);
+            b = (wyhash_leer32(p + largo - 4) << 32) | wyhash_leer32(p + largo - 4 - medio);
+        } else if (largo > 0) {
+            a = ((uint64_t) p[0] << 16) | ((uint64_t) p[largo >> 1] << 8) | p[largo - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t resto = largo;
+        if (resto > 48) {
+            uint64_t semilla1 = semilla, semilla2 = semilla;
+            do {
+                semilla = wyhash_mezclar128(wyhash_leer64(p) ^ secreto[1], wyhash_leer64(p + 8) ^ semilla);
+                semilla1 = wyhash_mezclar128(wyhash_leer64(p + 16) ^ secreto[2], wyhash_leer64(p + 24) ^ semilla1);
+                semilla2 = wyhash_mezclar128(wyhash_leer64(p + 32) ^ secreto[3], wyhash_leer64(p + 40) ^ semilla2);
+                p += 48;
+                resto -= 48;
+            } while (resto > 48);
+            semilla ^= semilla1 ^ semilla2;
+        }
+        while (resto > 16) {
+            semilla = wyhash_mezclar128(wyhash_leer64(p) ^ secreto[1], wyhash_leer64(p + 8) ^ semilla);
+            p += 16;
+            resto -= 16;
+        }
+        a = wyhash_leer64(p + resto - 16);
+        b = wyhash_leer64(p + resto - 8);
+    }
+    a ^= secreto[1];
+    b ^= semilla;
+    wyhash_multiplicar128(&a, &b);
+    return wyhash_mezclar128(a ^ secreto[0] ^ largo, b ^ secreto[1]);
+}
+
+#endif  // WYHASH_H